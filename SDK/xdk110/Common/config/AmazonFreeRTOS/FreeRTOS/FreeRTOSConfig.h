@@ -110,7 +110,7 @@ extern "C"
 #define configTOTAL_HEAP_SIZE                     (( size_t )(65 * 1024 ))
 #endif
 #define configMAX_TASK_NAME_LEN                   ( 10 )
-#define configUSE_TRACE_FACILITY                  ( 0 )
+#define configUSE_TRACE_FACILITY                  ( 1 )
 #define configUSE_16_BIT_TICKS                    ( 0 )
 #define configIDLE_SHOULD_YIELD                   ( 0 )
 #define configUSE_MUTEXES                         ( 1 )
@@ -135,7 +135,19 @@ extern "C"
 #endif
 
 /* Run time status gathering related definitions. */
-#define configGENERATE_RUN_TIME_STATS             ( 0 )
+#define configGENERATE_RUN_TIME_STATS             ( 1 )
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+/* Run time stats are clocked by the Cortex-M3 DWT cycle counter, started when the scheduler starts
+ * and read with a single load on every context switch. At 48 MHz it wraps every ~89 s, so consumers
+ * must work on counter deltas taken more often than that. */
+#define configCOREDEBUG_DEMCR                     ( *( ( volatile unsigned long * ) 0xE000EDFCUL ) )
+#define configCOREDEBUG_DEMCR_TRCENA              ( 1UL << 24 )
+#define configDWT_CTRL                            ( *( ( volatile unsigned long * ) 0xE0001000UL ) )
+#define configDWT_CTRL_CYCCNTENA                  ( 1UL << 0 )
+#define configDWT_CYCCNT                          ( *( ( volatile unsigned long * ) 0xE0001004UL ) )
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()  do { configCOREDEBUG_DEMCR |= configCOREDEBUG_DEMCR_TRCENA; configDWT_CYCCNT = 0UL; configDWT_CTRL |= configDWT_CTRL_CYCCNTENA; } while ( 0 )
+#define portGET_RUN_TIME_COUNTER_VALUE()          ( configDWT_CYCCNT )
+#endif
 
 /* Co-routine related definitions. */
 #define configUSE_CO_ROUTINES                     ( 0 )
@@ -165,7 +177,7 @@ extern "C"
 #define INCLUDE_xTaskGetSchedulerState            ( 1 )
 #define INCLUDE_xTaskGetCurrentTaskHandle         ( 1 )
 #define INCLUDE_uxTaskGetStackHighWaterMark       ( 0 )
-#define INCLUDE_xTaskGetIdleTaskHandle            ( 0 )
+#define INCLUDE_xTaskGetIdleTaskHandle            ( 1 )
 #define INCLUDE_xTimerGetTimerDaemonTaskHandle    ( 0 )
 #define INCLUDE_pcTaskGetTaskName                 ( 0 )
 #define INCLUDE_eTaskGetState                     ( 1 )
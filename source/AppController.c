@@ -38,9 +38,14 @@
 #include "BSP_BoardType.h"
 #include "BCDS_Assert.h"
 #include "BatteryMonitor.h"
+#include "Telemetry.h"
+#include "Deadband.h"
+#include "SdQualify.h"
+#include "Orientation.h"
 #include <FreeRTOS.h>
 #include <timers.h>
 #include <task.h>
+#include <semphr.h>
 
 /* constant definitions ***************************************************** */
 /* Ram buffers
@@ -53,12 +58,33 @@
 #define SINGLE_SECTOR_LEN           			UINT32_C(512)   /**< Single sector size in SDcard */
 #define INDEX_BUFFER_SIZE						UINT16_C(16)	/* Temporary file buffer size */
 #define APP_TEMPERATURE_OFFSET_CORRECTION       (-3459)
+#define TELEMETRY_CYCLES                        (TELEMETRY_INTERVAL / WRITEREAD_DELAY) /**< Sample cycles between telemetry records */
+#define LOG_FLUSH_INTERVAL                      UINT32_C(10000) /**< Longest millisecond time records wait in RAM, bounds the loss on power loss */
+#define LOG_SWITCH_TIMEOUT                      UINT32_C(2000)  /**< Millisecond time the previous session file gets to write its records */
+#define LOG_POLL_DELAY                          UINT32_C(10)    /**< Millisecond poll period while waiting for the log writer */
+#define ORIENTATION_RECORD_SIZE                 UINT8_C(80)     /**< Buffer size of a "Q;" record */
+
+/* A sample cycle logs the orientation records of the cycle, a sensor record and a telemetry record
+ * of at most their buffer sizes, SdQualify sizes the log buffer for that */
+#if (((ORIENTATION_ENABLED * ORIENTATION_OUTPUT_RATE * WRITEREAD_DELAY / UINT32_C(1000)) * ORIENTATION_RECORD_SIZE) + (2 * BUFFER_SIZE)) > SDQUALIFY_CYCLE_BYTES
+#error "A sample cycle can log more than SDQUALIFY_CYCLE_BYTES"
+#endif
 
 /* local variables ********************************************************** */
 static void 		Button1Callback(ButtonEvent_T);
 Retcode_T 			GetEndOfFileIndex(uint32_t*);
 Retcode_T 			SetEndOfFileIndex(uint32_t);
+static uint32_t 	LogRecordCount(void);
+static Retcode_T 	LogFlush(bool);
+static void 		LogRequestFlush(void);
+static void 		LogWriter(void*);
+static void 		LogSwitchFile(uint32_t);
+static Retcode_T 	LogFileWrite(const char*, uint32_t, uint32_t);
 static Retcode_T 	SensorDataWrite(Sensor_Value_T*, uint32_t, uint32_t, uint32_t);
+static Retcode_T 	TelemetryWrite(uint32_t, uint32_t);
+#if ORIENTATION_ENABLED
+static Retcode_T 	OrientationWrite(uint32_t, uint32_t);
+#endif /* ORIENTATION_ENABLED */
 
 static Button_Setup_T ButtonSetup =
 {
@@ -82,8 +108,8 @@ static Sensor_Setup_T SensorSetup =
 	.Enable =
 	{
 		.Accel = true,
-		.Mag = false,
-		.Gyro = false,
+		.Mag = ORIENTATION_ENABLED,
+		.Gyro = ORIENTATION_ENABLED,
 		.Humidity = true,
 		.Temp = true,
 		.Pressure = true,
@@ -124,10 +150,32 @@ static CmdProcessor_T * AppCmdProcessor;/**< Handle to store the main Command pr
 
 static xTaskHandle AppControllerHandle = NULL;/**< OS thread handle for Application controller to be used by run-time blocking threads */
 
+static xTaskHandle LogWriterHandle = NULL;/**< OS thread handle of the log writer */
+
+static SemaphoreHandle_t LogMutex = NULL;/**< Held by the log writer while flushing, and by the application to switch files or lend the buffer to the qualification */
+
+static uint8_t LogBuffer[SDQUALIFY_BUFFER_SIZE];/**< Ring of records waiting for a flush, FlushSize * BufferDepth bytes used, also the test pattern buffer of the SD card qualification */
+
+static SdQualify_Tuning_T LogTuning =
+{
+	.FlushSize = SDQUALIFY_DEFAULT_FLUSH,
+	.BufferDepth = SDQUALIFY_DEFAULT_DEPTH,
+};/**< Write batching parameters, loaded from the SD card at boot */
+
 /* global variables ********************************************************* */
 static bool enableWrite = false;
+static bool qualifyRequested = false;
+static TickType_t pressTick = 0;
 static uint32_t cycleNum = 1;
 static uint32_t eof_index = 0;
+static volatile bool logFlushAll = false;
+static volatile uint32_t logHead = 0;
+static volatile uint32_t logFill = 0;
+static uint32_t logFileIndex = 0;
+static uint32_t writeOffset = 0;
+#if DEADBAND_ENABLED
+static uint32_t deadbandFileIndex = 0;/**< Session file of the last buffered deadband record, file indices start at 1 */
+#endif /* DEADBAND_ENABLED */
 
 /* inline functions ********************************************************* */
 
@@ -137,23 +185,37 @@ static uint32_t eof_index = 0;
  * @brief Callback for Button 1.
  *
  * @param[in]    buttonEvent
- * If it is BUTTON_EVENT_PRESSED, then Red and Yellow LED's are turned ON
- * If it is BUTTON_EVENT_RELEASED, then Orange LED is turned ON
+ * A short press toggles the logging, the Orange LED blinks while logging.
+ * A press of at least SDQUALIFY_LONG_PRESS stops the logging and starts the SD card qualification.
  *
  */
 static void Button1Callback(ButtonEvent_T buttonEvent)
 {
 	Retcode_T retcode = RETCODE_OK;
+	bool isLongPress = false;
     switch (buttonEvent) {
     case BUTTON_EVENT_PRESSED:
+    	pressTick = xTaskGetTickCount();
+        break;
+
+    case BUTTON_EVENT_RELEASED:
+    	isLongPress = (((xTaskGetTickCount() - pressTick) * portTICK_PERIOD_MS) >= SDQUALIFY_LONG_PRESS);
     	if (enableWrite)
     	{
     		cycleNum = 1;
     		retcode = SetEndOfFileIndex(++eof_index); /* Set index position on auxiliary file */
     		if (RETCODE_OK != retcode) Retcode_RaiseError(retcode);
-    		xTaskAbortDelay(AppControllerHandle);
     	}
-    	enableWrite = !enableWrite;
+    	if (isLongPress)
+    	{
+    		enableWrite = false;
+    		qualifyRequested = true;
+    	}
+    	else
+    	{
+    		enableWrite = !enableWrite;
+    	}
+    	if (!enableWrite) xTaskAbortDelay(AppControllerHandle);
     	LED_Blink(enableWrite, LED_INBUILT_ORANGE, 250UL, 1000UL);
         break;
 
@@ -219,6 +281,252 @@ Retcode_T SetEndOfFileIndex(uint32_t count_num)
     return (retcode);
 } /* SetEndOfFileIndex */
 
+/**
+ * @brief Counts the buffered records, every record ends with a newline.
+ */
+static uint32_t LogRecordCount(void)
+{
+	uint32_t capacity = LogTuning.FlushSize * LogTuning.BufferDepth;
+	uint32_t records = 0;
+	for (uint32_t i = 0; i < logFill; i++)
+	{
+		if ('\n' == LogBuffer[(logHead + i) % capacity]) records++;
+	}
+	return (records);
+} /* LogRecordCount */
+
+/**
+ * @brief Writes the buffered records to their session file in blocks of the tuned flush size.
+ * Runs on the log writer task with LogMutex held. A block following a partial flush is shortened
+ * to bring the file offset back onto a flush size boundary.
+ *
+ * @param[in] all
+ * Also write the last partial block
+ */
+static Retcode_T LogFlush(bool all)
+{
+	char fileName[16];
+	sprintf(fileName, "data_%2ld.csv", logFileIndex);
+
+    Storage_Write_T writeCredentials =
+	{
+		.FileName = fileName,
+		.WriteBuffer = LogBuffer,
+		.BytesToWrite = 0UL,
+		.ActualBytesWritten = 0UL,
+		.Offset = 0UL,
+	};
+
+    Retcode_T retcode = RETCODE_OK;
+    uint32_t capacity = LogTuning.FlushSize * LogTuning.BufferDepth;
+	while (RETCODE_OK == retcode)
+	{
+		taskENTER_CRITICAL();
+		uint32_t head = logHead;
+		uint32_t fill = logFill;
+		taskEXIT_CRITICAL();
+
+		uint32_t block = LogTuning.FlushSize - (writeOffset % LogTuning.FlushSize);
+		if ((0UL == fill) || ((!all) && (fill < block))) break;
+		if (block > fill) block = fill;
+		if (block > (capacity - head)) block = capacity - head;
+
+		writeCredentials.WriteBuffer = &LogBuffer[head];
+		writeCredentials.BytesToWrite = block;
+		writeCredentials.Offset = writeOffset;
+		retcode = Storage_Write(STORAGE_MEDIUM_SD_CARD, &writeCredentials);
+		if (RETCODE_OK == retcode)
+		{
+			writeOffset += writeCredentials.ActualBytesWritten;
+			taskENTER_CRITICAL();
+			logHead = (head + block) % capacity;
+			logFill -= block;
+			taskEXIT_CRITICAL();
+		}
+		else
+		{
+			Telemetry_CountSdRetry();
+		}
+	}
+
+    return (retcode);
+} /* LogFlush */
+
+/**
+ * @brief Wakes the log writer to write every buffered record, including the last partial block.
+ */
+static void LogRequestFlush(void)
+{
+	logFlushAll = true;
+	xTaskNotifyGive(LogWriterHandle);
+} /* LogRequestFlush */
+
+/**
+ * @brief Log writer task, drains the RAM log buffer to the SD card so a card stall does not hold
+ * up the sample cycle. Full blocks are written when the application signals them, everything
+ * buffered at least every LOG_FLUSH_INTERVAL to bound the records lost on power loss.
+ * A failed flush keeps its records buffered, it is retried on the next wake up.
+ *
+ * @param[in] pvParameters
+ * Unused
+ */
+static void LogWriter(void* pvParameters)
+{
+    BCDS_UNUSED(pvParameters);
+
+    while (1)
+    {
+    	bool all = (0UL == ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LOG_FLUSH_INTERVAL)));
+    	if (logFlushAll)
+    	{
+    		logFlushAll = false;
+    		all = true;
+    	}
+    	(void) xSemaphoreTake(LogMutex, portMAX_DELAY);
+    	(void) LogFlush(all);
+    	(void) xSemaphoreGive(LogMutex);
+    }
+} /* LogWriter */
+
+/**
+ * @brief Starts a new session file. The log writer gets up to LOG_SWITCH_TIMEOUT to write the
+ * remaining records of the previous file, the records still buffered after it are dropped.
+ *
+ * @param[in] fileCount
+ * Session file index
+ */
+static void LogSwitchFile(uint32_t fileCount)
+{
+	uint32_t waited = 0;
+
+	if (logFill > 0UL) LogRequestFlush();
+	while ((logFill > 0UL) && (waited < LOG_SWITCH_TIMEOUT))
+	{
+		vTaskDelay(pdMS_TO_TICKS(LOG_POLL_DELAY));
+		waited += LOG_POLL_DELAY;
+	}
+
+	(void) xSemaphoreTake(LogMutex, portMAX_DELAY);
+	if (logFill > 0UL)
+	{
+		Telemetry_CountSdFailure(LogRecordCount());
+	}
+	taskENTER_CRITICAL();
+	logHead = 0;
+	logFill = 0;
+	taskEXIT_CRITICAL();
+	logFileIndex = fileCount;
+	writeOffset = 0;
+	(void) xSemaphoreGive(LogMutex);
+} /* LogSwitchFile */
+
+/**
+ * @brief Appends a record to the session file through the RAM log buffer, the log writer task
+ * writes it to the card. Only a record dropped on a full buffer is reported as error.
+ *
+ * @param[in] buffer
+ * Record text
+ *
+ * @param[in] length
+ * Number of bytes to append
+ *
+ * @param[in] fileCount
+ * Session file index
+ */
+static Retcode_T LogFileWrite(const char *buffer, uint32_t length, uint32_t fileCount)
+{
+	if (fileCount != logFileIndex)
+	{
+		LogSwitchFile(fileCount);
+	}
+
+	uint32_t capacity = LogTuning.FlushSize * LogTuning.BufferDepth;
+	taskENTER_CRITICAL();
+	uint32_t tail = (logHead + logFill) % capacity;
+	uint32_t fill = logFill;
+	taskEXIT_CRITICAL();
+
+	if ((fill + length) > capacity)
+	{
+		/* The card kept failing or stalling until the buffer filled up, drop the record */
+		Telemetry_CountSdFailure(1UL);
+		return (RETCODE(RETCODE_SEVERITY_WARNING, RETCODE_OUT_OF_RESOURCES));
+	}
+
+	/* The free space is only written here, the log writer only reads the buffered records */
+	uint32_t first = ((capacity - tail) < length) ? (capacity - tail) : length;
+	memcpy(&LogBuffer[tail], buffer, first);
+	memcpy(LogBuffer, &buffer[first], length - first);
+
+	taskENTER_CRITICAL();
+	logFill += length;
+	fill = logFill;
+	taskEXIT_CRITICAL();
+
+	if (fill >= LogTuning.FlushSize) xTaskNotifyGive(LogWriterHandle);
+
+    return (RETCODE_OK);
+} /* LogFileWrite */
+
+#if DEADBAND_ENABLED
+/**
+ * @brief Writes the channels which left their deadband as "D; <ms>; <mask>; <values>" record.
+ * Samples without any such channel are skipped. Until a record reached the buffer of the current
+ * session file every channel is written, so each file starts with a complete sample.
+ */
+static Retcode_T SensorDataWrite(Sensor_Value_T *sensor_value, uint32_t battery_voltage, uint32_t fileCount, uint32_t cycle)
+{
+    char publishBuffer[BUFFER_SIZE];
+    int32_t value[DEADBAND_CHANNELS];
+    uint32_t timestamp = cycle * WRITEREAD_DELAY;
+
+    value[DEADBAND_CHANNEL_ACCEL_X] = (int32_t) sensor_value->Accel.X;
+    value[DEADBAND_CHANNEL_ACCEL_Y] = (int32_t) sensor_value->Accel.Y;
+    value[DEADBAND_CHANNEL_ACCEL_Z] = (int32_t) sensor_value->Accel.Z;
+    value[DEADBAND_CHANNEL_HUMIDITY] = (int32_t) sensor_value->RH;
+    value[DEADBAND_CHANNEL_PRESSURE] = (int32_t) sensor_value->Pressure;
+    value[DEADBAND_CHANNEL_TEMPERATURE] = (int32_t) sensor_value->Temp;
+    value[DEADBAND_CHANNEL_LIGHT] = (int32_t) sensor_value->Light;
+    value[DEADBAND_CHANNEL_BATTERY] = (int32_t) battery_voltage;
+
+    if (fileCount != deadbandFileIndex)
+    {
+        Deadband_Reset(); /* Every session file starts with a complete sample */
+    }
+    uint8_t mask = Deadband_Filter(value, timestamp);
+    if (0U == mask)
+    {
+        return (RETCODE_OK);
+    }
+
+    int32_t length = snprintf(publishBuffer, BUFFER_SIZE, "D; %3ld; %02x", (long int) timestamp, (unsigned int) mask);
+    for (uint8_t channel = 0; channel < DEADBAND_CHANNELS; channel++)
+    {
+        if (0U == (mask & (1U << channel)))
+        {
+            continue;
+        }
+        if (channel < DEADBAND_CHANNEL_TEMPERATURE)
+        {
+            length += snprintf(&publishBuffer[length], BUFFER_SIZE - length, "; %3ld", (long int) value[channel]);
+        }
+        else
+        {
+            length += snprintf(&publishBuffer[length], BUFFER_SIZE - length, "; %.3f", (value[channel] / 1000.0));
+        }
+    }
+    length += snprintf(&publishBuffer[length], BUFFER_SIZE - length, "\n");
+
+    Retcode_T retcode = LogFileWrite(publishBuffer, length, fileCount);
+    if (RETCODE_OK == retcode)
+    {
+        Deadband_Commit(value, timestamp, mask);
+        deadbandFileIndex = fileCount;
+    }
+
+    return (retcode);
+} /* SensorDataWrite */
+#else
 static Retcode_T SensorDataWrite(Sensor_Value_T *sensor_value, uint32_t battery_voltage, uint32_t fileCount, uint32_t cycle)
 {
     char publishBuffer[BUFFER_SIZE];
@@ -238,32 +546,61 @@ static Retcode_T SensorDataWrite(Sensor_Value_T *sensor_value, uint32_t battery_
 						(sensor_value->Light / 1000.0),
 						(battery_voltage / 1000.0));
 
-	char fileName[16];
-	sprintf(fileName, "data_%2ld.csv", fileCount);
+    return (LogFileWrite(publishBuffer, length, fileCount));
+} /* SensorDataWrite */
+#endif /* DEADBAND_ENABLED */
 
-	static uint32_t writeOffset = 0;
+/**
+ * @brief Interleaves a telemetry record (task CPU share, queue depth, SD retries) in the session file.
+ *
+ * @param[in] fileCount
+ * Session file index
+ *
+ * @param[in] cycle
+ * Current sample cycle, used as the record timestamp
+ */
+static Retcode_T TelemetryWrite(uint32_t fileCount, uint32_t cycle)
+{
+    static char telemetryBuffer[BUFFER_SIZE]; /* Static to keep the task stack budget unchanged */
+    uint32_t length = 0;
 
-    Storage_Write_T writeCredentials =
-	{
-		.FileName = fileName,
-		.WriteBuffer = NULL,
-		.BytesToWrite = length,
-		.ActualBytesWritten = 0UL,
-		.Offset = 0UL,
-	};
+    Retcode_T retcode = Telemetry_GetRecord(telemetryBuffer, BUFFER_SIZE, cycle * WRITEREAD_DELAY, &length);
+    if ((RETCODE_OK == retcode) && (length > 0UL)) retcode = LogFileWrite(telemetryBuffer, length, fileCount);
 
-    writeCredentials.WriteBuffer = (uint8_t *) publishBuffer;
-    writeCredentials.Offset = writeOffset;
+    return (retcode);
+} /* TelemetryWrite */
 
+#if ORIENTATION_ENABLED
+/**
+ * @brief Writes the orientation records buffered since the previous sample, ahead of the sample record.
+ * The buffer is drained completely even if a write fails, so the next drain starts at this cycle.
+ *
+ * @param[in] fileCount
+ * Session file index
+ *
+ * @param[in] cycle
+ * Current sample cycle, the records are timed up to it
+ */
+static Retcode_T OrientationWrite(uint32_t fileCount, uint32_t cycle)
+{
+    char orientationBuffer[ORIENTATION_RECORD_SIZE];
+    uint32_t length = 0;
     Retcode_T retcode = RETCODE_OK;
-	retcode = Storage_Write(STORAGE_MEDIUM_SD_CARD, &writeCredentials);
-    if (RETCODE_OK == retcode)
+    Retcode_T writeRetcode = RETCODE_OK;
+
+    do
     {
-    	writeOffset += writeCredentials.ActualBytesWritten;
-    }
+        retcode = Orientation_GetRecord(orientationBuffer, ORIENTATION_RECORD_SIZE, cycle * WRITEREAD_DELAY, &length);
+        if ((RETCODE_OK == retcode) && (length > 0UL))
+        {
+            Retcode_T recordRetcode = LogFileWrite(orientationBuffer, length, fileCount);
+            if (RETCODE_OK == writeRetcode) writeRetcode = recordRetcode;
+        }
+    } while ((RETCODE_OK == retcode) && (length > 0UL));
 
-    return (retcode);
-} /* SensorDataWrite */
+    return ((RETCODE_OK == retcode) ? writeRetcode : retcode);
+} /* OrientationWrite */
+#endif /* ORIENTATION_ENABLED */
 
 /**
  * @brief Responsible for controlling the SD card example flow
@@ -278,6 +615,7 @@ static void AppControllerFire(void* pvParameters)
     Retcode_T retcode = RETCODE_OK;
     Sensor_Value_T sensorValue;
     uint32_t batteryValue;
+    uint32_t cycle;
     bool status = false;
 
     memset(&sensorValue, 0x00, sizeof(sensorValue));
@@ -293,6 +631,12 @@ static void AppControllerFire(void* pvParameters)
         assert(0);
     }
 
+	if (RETCODE_OK != SdQualify_Load(&LogTuning)) /* Get write batching parameters of the qualified card */
+	{
+		printf("[SD CARD] Card not qualified, hold Button 1 for %ld ms to qualify it.\n", (long int) SDQUALIFY_LONG_PRESS);
+	}
+	printf("[SD CARD] Flush size %ld, buffer depth %d.\n", (long int) LogTuning.FlushSize, (int) LogTuning.BufferDepth);
+
     while (1)
     {
     	if (enableWrite)
@@ -303,11 +647,23 @@ static void AppControllerFire(void* pvParameters)
 
 			if ((RETCODE_OK == retcode) && (true == status))
 			{
+				cycle = cycleNum++;
+				if (1UL == cycle) (void) Telemetry_StartPeriod(); /* The first record of a session measures from its start */
+#if ORIENTATION_ENABLED
+				Orientation_LockSensors();
+#endif /* ORIENTATION_ENABLED */
 				if (RETCODE_OK == retcode) retcode = Sensor_GetData(&sensorValue);
+#if ORIENTATION_ENABLED
+				Orientation_UnlockSensors();
+#endif /* ORIENTATION_ENABLED */
 				if (RETCODE_OK == retcode) retcode = BatteryMonitor_MeasureSignal(&batteryValue);
-				if (RETCODE_OK == retcode) retcode = SensorDataWrite(&sensorValue, batteryValue, eof_index, cycleNum++);
+#if ORIENTATION_ENABLED
+				if (RETCODE_OK == retcode) retcode = OrientationWrite(eof_index, cycle);
+#endif /* ORIENTATION_ENABLED */
+				if (RETCODE_OK == retcode) retcode = SensorDataWrite(&sensorValue, batteryValue, eof_index, cycle);
 				if (RETCODE_OK == retcode) printf("[SD CARD] Write succesful!\n");
 				else printf("[SD CARD] Write error.\n");
+				if ((RETCODE_OK == retcode) && (0UL == (cycle % TELEMETRY_CYCLES))) retcode = TelemetryWrite(eof_index, cycle);
 			}
 
 			if (cycleNum >= 65535UL)
@@ -327,6 +683,18 @@ static void AppControllerFire(void* pvParameters)
     	else
     	{
     		LED_On(LED_INBUILT_RED);
+    		if (logFill > 0UL) LogRequestFlush(); /* Logging stopped, write the remaining records */
+    		if (qualifyRequested && (0UL == logFill))
+    		{
+    			LED_On(LED_INBUILT_YELLOW);
+    			(void) xSemaphoreTake(LogMutex, portMAX_DELAY); /* The log writer stays off the buffer and the tuning */
+    			retcode = SdQualify_Run(LogBuffer, sizeof(LogBuffer), &LogTuning);
+    			logHead = 0;
+    			(void) xSemaphoreGive(LogMutex);
+    			if (RETCODE_OK != retcode) Retcode_RaiseError(retcode);
+    			qualifyRequested = false;
+    			LED_Off(LED_INBUILT_YELLOW);
+    		}
     		vTaskDelay(pdMS_TO_TICKS(1000UL));
     	}
     }
@@ -338,6 +706,8 @@ static void AppControllerFire(void* pvParameters)
  * - LED
  * - Button
  * - Sensor
+ * - Orientation
+ * - Log writer
  *
  * @param[in] param1
  * Unused
@@ -355,6 +725,17 @@ static void AppControllerEnable(void * param1, uint32_t param2)
     if (RETCODE_OK == retcode) retcode = LED_Enable();
     if (RETCODE_OK == retcode) retcode = Button_Enable();
     if (RETCODE_OK == retcode) retcode = Sensor_Enable();
+#if ORIENTATION_ENABLED
+    if (RETCODE_OK == retcode) retcode = Orientation_Enable();
+#endif /* ORIENTATION_ENABLED */
+    if (RETCODE_OK == retcode)
+    {
+        LogMutex = xSemaphoreCreateMutex();
+        if ((NULL == LogMutex) || (pdPASS != xTaskCreate(LogWriter, (const char * const ) "LogWriter", TASK_STACK_SIZE_LOG_WRITER, NULL, TASK_PRIO_LOG_WRITER, &LogWriterHandle)))
+        {
+            retcode = RETCODE(RETCODE_SEVERITY_ERROR, RETCODE_OUT_OF_RESOURCES);
+        }
+    }
     if (RETCODE_OK == retcode)
     {
         if (pdPASS != xTaskCreate(AppControllerFire, (const char * const ) "AppController", TASK_STACK_SIZE_APP_CONTROLLER, NULL, TASK_PRIO_APP_CONTROLLER, &AppControllerHandle))
@@ -380,6 +761,7 @@ static void AppControllerEnable(void * param1, uint32_t param2)
  * - Button
  * - Sensor
  * - Battery Monitor
+ * - Telemetry
  *
  * @param[in] param1
  * Unused
@@ -406,6 +788,7 @@ static void AppControllerSetup(void * param1, uint32_t param2)
         retcode = Sensor_Setup(&SensorSetup);
     }
     if (RETCODE_OK == retcode) retcode = BatteryMonitor_Init();
+    if (RETCODE_OK == retcode) retcode = Telemetry_Setup(AppCmdProcessor);
     if (RETCODE_OK == retcode) retcode = CmdProcessor_Enqueue(AppCmdProcessor, AppControllerEnable, NULL, UINT32_C(0));
     if (RETCODE_OK != retcode)
     {
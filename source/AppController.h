@@ -8,6 +8,8 @@
 /* local type and macro definitions */
 #define FAT_FILE_SYSTEM             1 /** Macro to write data into SDCard either through FAT file system or SingleBlockWriteRead depends on the value **/
 #define WRITEREAD_DELAY             UINT32_C(500)   /**< Millisecond delay for WriteRead timer task */
+#define DEADBAND_ENABLED            0 /** Macro to write only the channels which left their deadband ("D;" records) or full sample rows, depends on the value **/
+#define ORIENTATION_ENABLED         1 /** Macro to fuse accelerometer, gyroscope and magnetometer into "Q;" orientation records, depends on the value **/
 
 /* local function prototype declarations */
 
@@ -0,0 +1,103 @@
+/**
+ * @ingroup APPS_LIST
+ *
+ * @defgroup DEADBAND Deadband
+ * @{
+ *
+ * @brief Per channel deadband filter of the sampled values.
+ *
+ * @details Environmental channels rarely change between sample cycles. The filter keeps the last
+ * stored value of every channel and only lets a channel through when it leaves the deadband around
+ * that value or when its heartbeat expires. The logger writes the passed channels behind a presence
+ * mask, and the host tools hold the previous value of the other channels.
+ *
+ * @file
+ **/
+
+/* module includes ********************************************************** */
+
+/* own header files */
+#include "XdkAppInfo.h"
+#undef BCDS_MODULE_ID  /* Module ID define before including Basics package*/
+#define BCDS_MODULE_ID XDK_APP_MODULE_ID_DEADBAND
+
+/* own header files */
+#include "Deadband.h"
+
+/* system header files */
+
+/* additional interface header files */
+
+/* constant definitions ***************************************************** */
+
+/* local variables ********************************************************** */
+static const int32_t Threshold[DEADBAND_CHANNELS] =
+{
+    DEADBAND_ACCEL,
+    DEADBAND_ACCEL,
+    DEADBAND_ACCEL,
+    DEADBAND_HUMIDITY,
+    DEADBAND_PRESSURE,
+    DEADBAND_TEMPERATURE,
+    DEADBAND_LIGHT,
+    DEADBAND_BATTERY,
+};/**< Deadband half width of every channel */
+
+static int32_t StoredValue[DEADBAND_CHANNELS];/**< Last stored value of every channel */
+static uint32_t StoredTime[DEADBAND_CHANNELS];/**< Session time of the last stored value of every channel */
+
+/* global variables ********************************************************* */
+static bool isStored = false;
+
+/* inline functions ********************************************************* */
+
+/* local functions ********************************************************** */
+
+/* global functions ********************************************************* */
+
+/** Refer interface header for description */
+void Deadband_Reset(void)
+{
+    isStored = false;
+} /* Deadband_Reset */
+
+/** Refer interface header for description */
+uint8_t Deadband_Filter(const int32_t * value, uint32_t timestamp)
+{
+    uint8_t mask = 0;
+
+    for (uint8_t channel = 0; channel < DEADBAND_CHANNELS; channel++)
+    {
+        int32_t delta = value[channel] - StoredValue[channel];
+        if (delta < 0)
+        {
+            delta = -delta;
+        }
+        if ((!isStored) || (delta > Threshold[channel]) || ((timestamp - StoredTime[channel]) >= DEADBAND_HEARTBEAT))
+        {
+            mask |= (uint8_t) (1U << channel);
+        }
+    }
+
+    return (mask);
+} /* Deadband_Filter */
+
+/** Refer interface header for description */
+void Deadband_Commit(const int32_t * value, uint32_t timestamp, uint8_t mask)
+{
+    for (uint8_t channel = 0; channel < DEADBAND_CHANNELS; channel++)
+    {
+        if (0U != (mask & (1U << channel)))
+        {
+            StoredValue[channel] = value[channel];
+            StoredTime[channel] = timestamp;
+        }
+    }
+    if (0U != mask)
+    {
+        isStored = true; /* The first record after a reset holds every channel */
+    }
+} /* Deadband_Commit */
+
+/**@} */
+/** ************************************************************************* */
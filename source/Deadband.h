@@ -0,0 +1,71 @@
+/* header definition ******************************************************** */
+#ifndef DEADBAND_H_
+#define DEADBAND_H_
+
+/* local interface declaration ********************************************** */
+#include "XDK_Utils.h"
+
+/* local type and macro definitions */
+#define DEADBAND_HEARTBEAT          UINT32_C(60000) /**< Millisecond interval after which a channel is stored even if unchanged */
+
+#define DEADBAND_ACCEL              INT32_C(20)     /**< Accelerometer threshold [mG] */
+#define DEADBAND_HUMIDITY           INT32_C(1)      /**< Humidity threshold [%] */
+#define DEADBAND_PRESSURE           INT32_C(10)     /**< Pressure threshold [Pa] */
+#define DEADBAND_TEMPERATURE        INT32_C(100)    /**< Temperature threshold [mC] */
+#define DEADBAND_LIGHT              INT32_C(10000)  /**< Light threshold [mLux] */
+#define DEADBAND_BATTERY            INT32_C(20)     /**< Battery voltage threshold [mV] */
+
+/** Logged channels, in record order. The bit of a channel in the presence mask is (1 << channel). */
+enum Deadband_Channel_E
+{
+    DEADBAND_CHANNEL_ACCEL_X = 0,
+    DEADBAND_CHANNEL_ACCEL_Y,
+    DEADBAND_CHANNEL_ACCEL_Z,
+    DEADBAND_CHANNEL_HUMIDITY,
+    DEADBAND_CHANNEL_PRESSURE,
+    DEADBAND_CHANNEL_TEMPERATURE,
+    DEADBAND_CHANNEL_LIGHT,
+    DEADBAND_CHANNEL_BATTERY,
+    DEADBAND_CHANNELS
+};
+
+/* local function prototype declarations */
+
+/* local inline function definitions */
+
+/**
+ * @brief Forgets the stored values, so the next call of Deadband_Filter() stores every channel.
+ * Used at the start of a session file to keep each file reconstructible on its own.
+ */
+void Deadband_Reset(void);
+
+/**
+ * @brief Decides which channels of a sample are stored, the decision takes effect with Deadband_Commit().
+ *
+ * A channel is stored when it moved more than its threshold away from its last stored value,
+ * or when it has not been stored for DEADBAND_HEARTBEAT.
+ *
+ * @param[in] value Channel values in integer units, indexed by Deadband_Channel_E
+ *
+ * @param[in] timestamp Session time of the sample in milliseconds
+ *
+ * @return Presence mask of the channels to store, 0 if the sample can be skipped
+ */
+uint8_t Deadband_Filter(const int32_t * value, uint32_t timestamp);
+
+/**
+ * @brief Takes the channels of a record as stored, once the record made it into the log.
+ * Until then Deadband_Filter() keeps selecting them, so a dropped record is followed by one
+ * carrying the same channels.
+ *
+ * @param[in] value Channel values in integer units, indexed by Deadband_Channel_E
+ *
+ * @param[in] timestamp Session time of the sample in milliseconds
+ *
+ * @param[in] mask Presence mask returned by Deadband_Filter() for the record
+ */
+void Deadband_Commit(const int32_t * value, uint32_t timestamp, uint8_t mask);
+
+#endif /* DEADBAND_H_ */
+
+/** ************************************************************************* */
@@ -0,0 +1,233 @@
+/**
+ * @ingroup APPS_LIST
+ *
+ * @defgroup FUSION Fusion
+ * @{
+ *
+ * @brief Fixed-point Mahony orientation filter.
+ *
+ * @details Port of the Mahony AHRS update to Q29 integer arithmetic for the FPU-less Cortex-M3.
+ * The gyro rate is converted straight into the half rotation angle per sample, so the time step
+ * and the feedback gains are folded into integer constants at compile time. The module has no
+ * XDK dependencies, the host tool tools/XdkFusion.c checks it against the floating-point reference.
+ *
+ * @file
+ **/
+
+/* module includes ********************************************************** */
+
+/* own header files */
+#include "Fusion.h"
+
+/* system header files */
+#include <stdbool.h>
+#include <stddef.h>
+
+/* constant definitions ***************************************************** */
+#define PI                          3.14159265358979323846
+#define ONE                         ((int32_t) 1 << FUSION_Q)
+#define HALF                        ((int32_t) 1 << (FUSION_Q - 1))
+#define SCALE_Q                     16      /**< Extra fractional bits of the scale constants */
+
+/** Half angle per sample [Q29 rad] of 1 mdeg/s, with SCALE_Q extra fractional bits */
+#define GYRO_SCALE                  ((int64_t) ((PI / 180000.0) * (0.5 / FUSION_RATE) * (double) (1ULL << (FUSION_Q + SCALE_Q)) + 0.5))
+/** Proportional feedback per sample, 2 * Kp * dt / 2 in Q29 */
+#define KP_STEP                     ((int32_t) (FUSION_TWO_KP * (0.5 / FUSION_RATE) * (double) ONE + 0.5))
+/** Integral feedback per sample, 2 * Ki * dt * dt / 2 in Q29, with SCALE_Q extra fractional bits */
+#define KI_STEP                     ((int64_t) (FUSION_TWO_KI * (0.5 / (FUSION_RATE * FUSION_RATE)) * (double) (1ULL << (FUSION_Q + SCALE_Q)) + 0.5))
+#define EARTH_GRAVITY               INT64_C(1000) /**< 1 g [mG] */
+
+/* local functions ********************************************************** */
+
+static inline int32_t Mul(int32_t a, int32_t b)
+{
+    return ((int32_t) (((int64_t) a * b) >> FUSION_Q));
+}
+
+/**
+ * @brief Integer square root, rounded down.
+ */
+static uint32_t SquareRoot(uint64_t value)
+{
+    uint64_t root = 0;
+    uint64_t bit = (uint64_t) 1 << 62;
+
+    while (bit > value)
+    {
+        bit >>= 2;
+    }
+    while (0U != bit)
+    {
+        if (value >= (root + bit))
+        {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return ((uint32_t) root);
+} /* SquareRoot */
+
+/**
+ * @brief Scales a sensor vector (at most 2^22 per axis) to a Q29 unit vector.
+ *
+ * @return false for a zero vector
+ */
+static bool Normalize(const int32_t * vector, int32_t * unit)
+{
+    uint64_t sum = 0;
+    for (uint8_t i = 0; i < 3U; i++)
+    {
+        int64_t scaled = (int64_t) vector[i] * 256;
+        sum += (uint64_t) (scaled * scaled);
+    }
+    if (0U == sum)
+    {
+        return (false);
+    }
+    /* norm carries 8 fractional bits, so vector * 2^52 / norm is the unit vector in Q44 */
+    int64_t inverse = ((int64_t) 1 << 52) / (int64_t) SquareRoot(sum);
+    for (uint8_t i = 0; i < 3U; i++)
+    {
+        unit[i] = (int32_t) (((int64_t) vector[i] * inverse) >> (52 - 8 - FUSION_Q));
+    }
+    return (true);
+} /* Normalize */
+
+/* global functions ********************************************************* */
+
+/** Refer interface header for description */
+void Fusion_Init(Fusion_State_T * state)
+{
+    state->Q[0] = ONE;
+    state->Q[1] = 0;
+    state->Q[2] = 0;
+    state->Q[3] = 0;
+    state->Integral[0] = 0;
+    state->Integral[1] = 0;
+    state->Integral[2] = 0;
+} /* Fusion_Init */
+
+/** Refer interface header for description */
+void Fusion_Update(Fusion_State_T * state, const Fusion_Sample_T * sample)
+{
+    int32_t q0 = state->Q[0];
+    int32_t q1 = state->Q[1];
+    int32_t q2 = state->Q[2];
+    int32_t q3 = state->Q[3];
+    int32_t g[3];
+    int32_t a[3];
+    int32_t m[3];
+
+    for (uint8_t i = 0; i < 3U; i++)
+    {
+        g[i] = (int32_t) (((int64_t) sample->Gyro[i] * GYRO_SCALE) >> SCALE_Q);
+    }
+
+    if (Normalize(sample->Accel, a))
+    {
+        int32_t q0q0 = Mul(q0, q0);
+        int32_t q0q1 = Mul(q0, q1);
+        int32_t q0q2 = Mul(q0, q2);
+        int32_t q0q3 = Mul(q0, q3);
+        int32_t q1q1 = Mul(q1, q1);
+        int32_t q1q2 = Mul(q1, q2);
+        int32_t q1q3 = Mul(q1, q3);
+        int32_t q2q2 = Mul(q2, q2);
+        int32_t q2q3 = Mul(q2, q3);
+        int32_t q3q3 = Mul(q3, q3);
+
+        /* Estimated direction of gravity, halved */
+        int32_t halfV0 = q1q3 - q0q2;
+        int32_t halfV1 = q0q1 + q2q3;
+        int32_t halfV2 = q0q0 - HALF + q3q3;
+
+        /* Error between measured and estimated direction of gravity */
+        int32_t e0 = Mul(a[1], halfV2) - Mul(a[2], halfV1);
+        int32_t e1 = Mul(a[2], halfV0) - Mul(a[0], halfV2);
+        int32_t e2 = Mul(a[0], halfV1) - Mul(a[1], halfV0);
+
+        if (Normalize(sample->Mag, m))
+        {
+            /* Reference direction of the earth magnetic field */
+            int32_t hx = 2 * (Mul(m[0], HALF - q2q2 - q3q3) + Mul(m[1], q1q2 - q0q3) + Mul(m[2], q1q3 + q0q2));
+            int32_t hy = 2 * (Mul(m[0], q1q2 + q0q3) + Mul(m[1], HALF - q1q1 - q3q3) + Mul(m[2], q2q3 - q0q1));
+            int32_t bx = (int32_t) SquareRoot((uint64_t) ((int64_t) hx * hx + (int64_t) hy * hy));
+            int32_t bz = 2 * (Mul(m[0], q1q3 - q0q2) + Mul(m[1], q2q3 + q0q1) + Mul(m[2], HALF - q1q1 - q2q2));
+
+            /* Estimated direction of the magnetic field, halved */
+            int32_t halfW0 = Mul(bx, HALF - q2q2 - q3q3) + Mul(bz, q1q3 - q0q2);
+            int32_t halfW1 = Mul(bx, q1q2 - q0q3) + Mul(bz, q0q1 + q2q3);
+            int32_t halfW2 = Mul(bx, q0q2 + q1q3) + Mul(bz, HALF - q1q1 - q2q2);
+
+            e0 += Mul(m[1], halfW2) - Mul(m[2], halfW1);
+            e1 += Mul(m[2], halfW0) - Mul(m[0], halfW2);
+            e2 += Mul(m[0], halfW1) - Mul(m[1], halfW0);
+        }
+
+        if (0 != KI_STEP)
+        {
+            state->Integral[0] += (int32_t) (((int64_t) e0 * KI_STEP) >> SCALE_Q);
+            state->Integral[1] += (int32_t) (((int64_t) e1 * KI_STEP) >> SCALE_Q);
+            state->Integral[2] += (int32_t) (((int64_t) e2 * KI_STEP) >> SCALE_Q);
+            g[0] += state->Integral[0];
+            g[1] += state->Integral[1];
+            g[2] += state->Integral[2];
+        }
+        g[0] += Mul(e0, KP_STEP);
+        g[1] += Mul(e1, KP_STEP);
+        g[2] += Mul(e2, KP_STEP);
+    }
+
+    /* Integrate the rate of change of the quaternion */
+    int32_t qa = q0;
+    int32_t qb = q1;
+    int32_t qc = q2;
+    q0 += -Mul(qb, g[0]) - Mul(qc, g[1]) - Mul(q3, g[2]);
+    q1 += Mul(qa, g[0]) + Mul(qc, g[2]) - Mul(q3, g[1]);
+    q2 += Mul(qa, g[1]) - Mul(qb, g[2]) + Mul(q3, g[0]);
+    q3 += Mul(qa, g[2]) + Mul(qb, g[1]) - Mul(qc, g[0]);
+
+    /* The norm stays close to one, a Newton step of 1 / sqrt(x) around 1 renormalizes without a division */
+    int32_t norm = (int32_t) (((int64_t) q0 * q0 + (int64_t) q1 * q1 + (int64_t) q2 * q2 + (int64_t) q3 * q3) >> FUSION_Q);
+    int32_t factor = (3 * HALF) - (norm / 2);
+    state->Q[0] = Mul(q0, factor);
+    state->Q[1] = Mul(q1, factor);
+    state->Q[2] = Mul(q2, factor);
+    state->Q[3] = Mul(q3, factor);
+} /* Fusion_Update */
+
+/** Refer interface header for description */
+void Fusion_GetQuaternion(const Fusion_State_T * state, int16_t * quaternion)
+{
+    for (uint8_t i = 0; i < 4U; i++)
+    {
+        int32_t rounded = (state->Q[i] + ((int32_t) 1 << (FUSION_Q - FUSION_OUTPUT_Q - 1))) >> (FUSION_Q - FUSION_OUTPUT_Q);
+        quaternion[i] = (int16_t) ((rounded > INT16_MAX) ? INT16_MAX : ((rounded < INT16_MIN) ? INT16_MIN : rounded));
+    }
+} /* Fusion_GetQuaternion */
+
+/** Refer interface header for description */
+void Fusion_GetLinearAccel(const Fusion_State_T * state, const int32_t * accel, int32_t * linear)
+{
+    int32_t q0 = state->Q[0];
+    int32_t q1 = state->Q[1];
+    int32_t q2 = state->Q[2];
+    int32_t q3 = state->Q[3];
+    int32_t gravity[3];
+
+    gravity[0] = 2 * (Mul(q1, q3) - Mul(q0, q2));
+    gravity[1] = 2 * (Mul(q0, q1) + Mul(q2, q3));
+    gravity[2] = Mul(q0, q0) - Mul(q1, q1) - Mul(q2, q2) + Mul(q3, q3);
+    for (uint8_t i = 0; i < 3U; i++)
+    {
+        linear[i] = accel[i] - (int32_t) (((int64_t) gravity[i] * EARTH_GRAVITY) >> FUSION_Q);
+    }
+} /* Fusion_GetLinearAccel */
+
+/**@} */
+/** ************************************************************************* */
@@ -0,0 +1,70 @@
+/* header definition ******************************************************** */
+#ifndef FUSION_H_
+#define FUSION_H_
+
+/* local interface declaration ********************************************** */
+#include <stdint.h>
+
+/* local type and macro definitions */
+#define FUSION_RATE                 100     /**< Sample rate of Fusion_Update() [Hz] */
+#define FUSION_TWO_KP               1.0     /**< Proportional feedback gain (2 * Kp), folded into constants at compile time */
+#define FUSION_TWO_KI               0.0     /**< Integral feedback gain (2 * Ki), folded into constants at compile time */
+#define FUSION_Q                    29      /**< Fractional bits of the internal fixed-point values */
+#define FUSION_OUTPUT_Q             14      /**< Fractional bits of the quaternion from Fusion_GetQuaternion() */
+#define FUSION_MAG_LSB              16      /**< Magnetometer counts per uT, the compensated BMM150 LSB is 1/16 uT */
+
+/** State of the orientation filter, quaternion and integral feedback in Q29 */
+typedef struct
+{
+    int32_t Q[4];           /**< Orientation quaternion w, x, y, z, sensor frame to earth frame */
+    int32_t Integral[3];    /**< Integral feedback, half angle per sample */
+} Fusion_State_T;
+
+/** One sample of the motion sensors in the units of the XDK sensor drivers */
+typedef struct
+{
+    int32_t Accel[3];       /**< Acceleration [mG] */
+    int32_t Gyro[3];        /**< Angular rate [mdeg/s] */
+    int32_t Mag[3];         /**< Magnetic field [1 / FUSION_MAG_LSB uT], all zero to fuse without magnetometer */
+} Fusion_Sample_T;
+
+/* local function prototype declarations */
+
+/* local inline function definitions */
+
+/**
+ * @brief Resets the filter to the identity orientation.
+ */
+void Fusion_Init(Fusion_State_T * state);
+
+/**
+ * @brief Fuses one sample into the orientation with the Mahony complementary filter.
+ *
+ * Only integer arithmetic is used: 32 x 32 -> 64 bit multiplications, one integer square root
+ * and one division per normalized vector. The quaternion is renormalized with a Newton step.
+ *
+ * @param[in,out] state Filter state
+ *
+ * @param[in] sample Motion sensor sample, taken every 1 / FUSION_RATE seconds
+ */
+void Fusion_Update(Fusion_State_T * state, const Fusion_Sample_T * sample);
+
+/**
+ * @brief Returns the orientation as quaternion with FUSION_OUTPUT_Q fractional bits per component.
+ */
+void Fusion_GetQuaternion(const Fusion_State_T * state, int16_t * quaternion);
+
+/**
+ * @brief Removes the estimated gravity from an acceleration sample.
+ *
+ * @param[in] state Filter state
+ *
+ * @param[in] accel Acceleration [mG]
+ *
+ * @param[out] linear Linear acceleration in the sensor frame [mG]
+ */
+void Fusion_GetLinearAccel(const Fusion_State_T * state, const int32_t * accel, int32_t * linear);
+
+#endif /* FUSION_H_ */
+
+/** ************************************************************************* */
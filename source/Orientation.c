@@ -0,0 +1,298 @@
+/**
+ * @ingroup APPS_LIST
+ *
+ * @defgroup ORIENTATION Orientation
+ * @{
+ *
+ * @brief Orientation stage of the datalogger.
+ *
+ * @details A task samples accelerometer, gyroscope and magnetometer at FUSION_RATE and fuses them
+ * with the fixed-point filter of Fusion.c. Only the quaternion and the averaged linear acceleration
+ * of every output period are kept, 16 bit per component, so the log gets the orientation for a
+ * fraction of the bandwidth of the raw 9 axes. The cycles spent in the filter are reported in the
+ * telemetry record.
+ *
+ * @file
+ **/
+
+/* module includes ********************************************************** */
+
+/* own header files */
+#include "XdkAppInfo.h"
+#undef BCDS_MODULE_ID  /* Module ID define before including Basics package*/
+#define BCDS_MODULE_ID XDK_APP_MODULE_ID_ORIENTATION
+
+/* own header files */
+#include "Orientation.h"
+
+/* system header files */
+#include <stdio.h>
+
+/* additional interface header files */
+#include "Telemetry.h"
+#include "XdkSensorHandle.h"
+#include "em_device.h"
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+
+/* constant definitions ***************************************************** */
+#define ORIENTATION_PERIOD          pdMS_TO_TICKS(UINT32_C(1000) / FUSION_RATE) /**< Ticks between two samples */
+#define ORIENTATION_DECIMATION      (FUSION_RATE / ORIENTATION_OUTPUT_RATE)      /**< Samples per output record */
+
+/** Orientation at the end of an output period */
+typedef struct
+{
+    TickType_t Tick;        /**< Tick count of the last sample */
+    int16_t Quaternion[4];  /**< Orientation in FUSION_OUTPUT_Q fixed point */
+    int16_t Linear[3];      /**< Averaged linear acceleration [mG] */
+} Orientation_Record_T;
+
+/* local variables ********************************************************** */
+static xTaskHandle OrientationHandle = NULL;/**< OS thread handle of the orientation task */
+
+static SemaphoreHandle_t SensorMutex = NULL;/**< Serializes the motion sensor reads of the orientation task and the application */
+
+static Fusion_State_T FusionState;/**< Orientation filter state */
+
+static Orientation_Record_T Records[ORIENTATION_RECORDS];/**< Ring of records waiting for the log, shared with the orientation task */
+static uint8_t RecordHead = 0;/**< Index of the oldest record */
+static uint8_t RecordCount = 0;
+
+/* global variables ********************************************************* */
+static bool drainActive = false;
+static bool drainValid = false;
+static TickType_t drainTick = 0;
+static TickType_t previousTick = 0;
+static uint32_t previousTimestamp = 0;
+
+/* inline functions ********************************************************* */
+
+/* local functions ********************************************************** */
+
+static int16_t Saturate(int32_t value)
+{
+    return ((int16_t) ((value > INT16_MAX) ? INT16_MAX : ((value < INT16_MIN) ? INT16_MIN : value)));
+} /* Saturate */
+
+/**
+ * @brief Reads accelerometer [mG], gyroscope [mdeg/s] and magnetometer [1/16 uT] under the sensor lock.
+ * The magnetometer is read in LSB, whole uT would limit the heading resolution to a few degrees.
+ */
+static Retcode_T ReadSample(Fusion_Sample_T * sample)
+{
+    Accelerometer_XyzData_T accel;
+    Gyroscope_XyzData_T gyro;
+    Magnetometer_XyzData_T mag;
+
+    Orientation_LockSensors();
+    Retcode_T retcode = Accelerometer_readXyzGValue(xdkAccelerometers_BMA280_Handle, &accel);
+    if (RETCODE_OK == retcode) retcode = Gyroscope_readXyzDegreeValue(xdkGyroscope_BMG160_Handle, &gyro);
+    if (RETCODE_OK == retcode) retcode = Magnetometer_readXyzLsbData(xdkMagnetometer_BMM150_Handle, &mag);
+    Orientation_UnlockSensors();
+
+    if (RETCODE_OK == retcode)
+    {
+        sample->Accel[0] = accel.xAxisData;
+        sample->Accel[1] = accel.yAxisData;
+        sample->Accel[2] = accel.zAxisData;
+        sample->Gyro[0] = gyro.xAxisData;
+        sample->Gyro[1] = gyro.yAxisData;
+        sample->Gyro[2] = gyro.zAxisData;
+        sample->Mag[0] = mag.xAxisData;
+        sample->Mag[1] = mag.yAxisData;
+        sample->Mag[2] = mag.zAxisData;
+    }
+    return (retcode);
+} /* ReadSample */
+
+/**
+ * @brief Appends a record to the ring, overwriting the oldest one when the log does not keep up.
+ */
+static void PushRecord(const Orientation_Record_T * record)
+{
+    taskENTER_CRITICAL();
+    if (RecordCount < ORIENTATION_RECORDS)
+    {
+        Records[(RecordHead + RecordCount) % ORIENTATION_RECORDS] = *record;
+        RecordCount++;
+    }
+    else
+    {
+        Records[RecordHead] = *record;
+        RecordHead = (RecordHead + 1U) % ORIENTATION_RECORDS;
+    }
+    taskEXIT_CRITICAL();
+} /* PushRecord */
+
+/**
+ * @brief Takes the oldest record out of the ring, unless it was taken after the drain started.
+ *
+ * @return false if no record of the current drain is left
+ */
+static bool PopRecord(Orientation_Record_T * record)
+{
+    bool popped = false;
+
+    taskENTER_CRITICAL();
+    if ((RecordCount > 0U) && ((int32_t) (Records[RecordHead].Tick - drainTick) <= 0))
+    {
+        *record = Records[RecordHead];
+        RecordHead = (RecordHead + 1U) % ORIENTATION_RECORDS;
+        RecordCount--;
+        popped = true;
+    }
+    taskEXIT_CRITICAL();
+
+    return (popped);
+} /* PopRecord */
+
+/**
+ * @brief Samples and fuses the motion sensors at FUSION_RATE.
+ *
+ * @param[in] pvParameters
+ * Unused
+ */
+static void OrientationTask(void * pvParameters)
+{
+    BCDS_UNUSED(pvParameters);
+
+    Fusion_Sample_T sample;
+    Orientation_Record_T record;
+    int32_t linear[3];
+    int32_t linearSum[3] = { 0, 0, 0 };
+    uint32_t samples = 0;
+    TickType_t wakeTick = xTaskGetTickCount();
+
+    Fusion_Init(&FusionState);
+
+    while (1)
+    {
+        vTaskDelayUntil(&wakeTick, ORIENTATION_PERIOD);
+        if (RETCODE_OK != ReadSample(&sample))
+        {
+            continue;
+        }
+
+        uint32_t startCycles = DWT->CYCCNT;
+        Fusion_Update(&FusionState, &sample);
+        Telemetry_CountFusionCycles(DWT->CYCCNT - startCycles);
+
+        Fusion_GetLinearAccel(&FusionState, sample.Accel, linear);
+        for (uint8_t i = 0; i < 3U; i++)
+        {
+            linearSum[i] += linear[i];
+        }
+
+        if (++samples >= ORIENTATION_DECIMATION)
+        {
+            record.Tick = xTaskGetTickCount();
+            Fusion_GetQuaternion(&FusionState, record.Quaternion);
+            for (uint8_t i = 0; i < 3U; i++)
+            {
+                record.Linear[i] = Saturate(linearSum[i] / (int32_t) samples);
+                linearSum[i] = 0;
+            }
+            samples = 0;
+            PushRecord(&record);
+        }
+    }
+} /* OrientationTask */
+
+/* global functions ********************************************************* */
+
+/** Refer interface header for description */
+Retcode_T Orientation_Enable(void)
+{
+    SensorMutex = xSemaphoreCreateMutex();
+    if (NULL == SensorMutex)
+    {
+        return (RETCODE(RETCODE_SEVERITY_ERROR, RETCODE_OUT_OF_RESOURCES));
+    }
+    if (pdPASS != xTaskCreate(OrientationTask, (const char * const ) "Orientation", TASK_STACK_SIZE_ORIENTATION, NULL, TASK_PRIO_ORIENTATION, &OrientationHandle))
+    {
+        return (RETCODE(RETCODE_SEVERITY_ERROR, RETCODE_OUT_OF_RESOURCES));
+    }
+    return (RETCODE_OK);
+} /* Orientation_Enable */
+
+/** Refer interface header for description */
+void Orientation_LockSensors(void)
+{
+    if (NULL != SensorMutex)
+    {
+        (void) xSemaphoreTake(SensorMutex, portMAX_DELAY);
+    }
+} /* Orientation_LockSensors */
+
+/** Refer interface header for description */
+void Orientation_UnlockSensors(void)
+{
+    if (NULL != SensorMutex)
+    {
+        (void) xSemaphoreGive(SensorMutex);
+    }
+} /* Orientation_UnlockSensors */
+
+/** Refer interface header for description */
+Retcode_T Orientation_GetRecord(char * buffer, uint32_t size, uint32_t timestamp, uint32_t * length)
+{
+    if ((NULL == buffer) || (NULL == length))
+    {
+        return (RETCODE(RETCODE_SEVERITY_ERROR, RETCODE_NULL_POINTER));
+    }
+    *length = 0;
+
+    if (!drainActive)
+    {
+        drainTick = xTaskGetTickCount();
+        drainActive = true;
+        if (!drainValid || (timestamp <= previousTimestamp))
+        {
+            /* First drain of a session file, only the records of the last timestamp milliseconds belong to it */
+            previousTick = drainTick - pdMS_TO_TICKS(timestamp);
+            previousTimestamp = 0;
+        }
+    }
+
+    Orientation_Record_T record;
+    while (PopRecord(&record))
+    {
+        int32_t sincePrevious = (int32_t) (record.Tick - previousTick);
+        if (sincePrevious <= 0)
+        {
+            continue; /* Taken before the previous drain */
+        }
+
+        /* Spread the tick counts linearly onto the session time between the two drains */
+        uint32_t window = (uint32_t) (drainTick - previousTick);
+        uint32_t recordTimestamp = previousTimestamp
+                + (uint32_t) (((uint64_t) sincePrevious * (timestamp - previousTimestamp)) / window);
+
+        int32_t written = snprintf(buffer, size, "Q; %ld; %d; %d; %d; %d; %d; %d; %d\n",
+                            (long int) recordTimestamp,
+                            (int) record.Quaternion[0],
+                            (int) record.Quaternion[1],
+                            (int) record.Quaternion[2],
+                            (int) record.Quaternion[3],
+                            (int) record.Linear[0],
+                            (int) record.Linear[1],
+                            (int) record.Linear[2]);
+        if ((written <= 0) || ((uint32_t) written >= size))
+        {
+            return (RETCODE(RETCODE_SEVERITY_WARNING, RETCODE_OUT_OF_RESOURCES));
+        }
+        *length = (uint32_t) written;
+        return (RETCODE_OK);
+    }
+
+    previousTick = drainTick;
+    previousTimestamp = timestamp;
+    drainValid = true;
+    drainActive = false;
+
+    return (RETCODE_OK);
+} /* Orientation_GetRecord */
+
+/**@} */
+/** ************************************************************************* */
@@ -0,0 +1,59 @@
+/* header definition ******************************************************** */
+#ifndef ORIENTATION_H_
+#define ORIENTATION_H_
+
+/* local interface declaration ********************************************** */
+#include "XDK_Utils.h"
+#include "Fusion.h"
+
+/* local type and macro definitions */
+#define ORIENTATION_OUTPUT_RATE     UINT32_C(10)    /**< Rate of the "Q;" records [Hz], FUSION_RATE must be a multiple of it */
+#define ORIENTATION_RECORDS         UINT8_C(16)     /**< Records buffered between two drains, the oldest is overwritten when full */
+
+/* local function prototype declarations */
+
+/* local inline function definitions */
+
+/**
+ * @brief Starts the orientation task, which samples accelerometer, gyroscope and magnetometer at
+ * FUSION_RATE and buffers one record per output period. The sensors must be enabled.
+ *
+ * @retval RETCODE_OK on success, RETCODE_OUT_OF_RESOURCES if the task or its mutex cannot be created
+ */
+Retcode_T Orientation_Enable(void);
+
+/**
+ * @brief Gives the orientation task exclusive access to the sensors. Other readers of the
+ * motion sensors, e.g. Sensor_GetData(), have to hold this lock.
+ */
+void Orientation_LockSensors(void);
+
+/**
+ * @brief Releases the lock taken by Orientation_LockSensors().
+ */
+void Orientation_UnlockSensors(void);
+
+/**
+ * @brief Formats the oldest buffered orientation record and removes it from the buffer.
+ *
+ * Record layout: "Q; <ms>; <w>; <x>; <y>; <z>; <lin x>; <lin y>; <lin z>"
+ * with the quaternion in FUSION_OUTPUT_Q fixed point and the linear acceleration [mG]
+ * averaged over the output period. Call it until the length is zero, the record times are
+ * spread between the timestamps of the previous and the current drain, records taken before
+ * the previous drain (e.g. while not logging) are discarded.
+ *
+ * @param[out] buffer Destination for the record text
+ *
+ * @param[in] size Size of the destination buffer
+ *
+ * @param[in] timestamp Session time of the current sample in milliseconds
+ *
+ * @param[out] length Number of characters written into the buffer, 0 if no record is left
+ *
+ * @retval RETCODE_OK on success
+ */
+Retcode_T Orientation_GetRecord(char * buffer, uint32_t size, uint32_t timestamp, uint32_t * length);
+
+#endif /* ORIENTATION_H_ */
+
+/** ************************************************************************* */
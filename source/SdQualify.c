@@ -0,0 +1,361 @@
+/**
+ * @ingroup APPS_LIST
+ *
+ * @defgroup SD_QUALIFY SdQualify
+ * @{
+ *
+ * @brief SD card qualification of the write batch size.
+ *
+ * @details Write latency differs a lot between SD card models, and some stall for hundreds of
+ * milliseconds during internal garbage collection. The qualification times appending writes of
+ * several block sizes and alignments through the same Storage_Write() path the log writer task
+ * uses, and stores the flush size and buffer depth the logger loads at boot. The module only
+ * relies on Storage_Write()/Storage_Read() and the RTOS tick, so it also runs against the host
+ * storage stand-in of the tools folder.
+ *
+ * @file
+ **/
+
+/* module includes ********************************************************** */
+
+/* own header files */
+#include "XdkAppInfo.h"
+#undef BCDS_MODULE_ID  /* Module ID define before including Basics package*/
+#define BCDS_MODULE_ID XDK_APP_MODULE_ID_SD_QUALIFY
+
+/* own header files */
+#include "SdQualify.h"
+
+/* system header files */
+#include <stdio.h>
+
+/* additional interface header files */
+#include "XDK_Storage.h"
+#include <FreeRTOS.h>
+#include <task.h>
+
+/* constant definitions ***************************************************** */
+#define QUALIFY_FILE_NAME           "qual.xdk"      /**< Test pattern file */
+#define REPORT_FILE_NAME            "qual.csv"      /**< Latency distribution report */
+#define TUNING_FILE_NAME            "tune.xdk"      /**< Tuning loaded at boot */
+#define BLOCK_SIZES                 UINT8_C(4)      /**< SDQUALIFY_MIN_BLOCK doubled up to SDQUALIFY_MAX_BLOCK */
+#define ALIGNMENTS                  UINT8_C(2)      /**< Sector aligned and misaligned runs */
+#define LINE_BUFFER_SIZE            UINT16_C(64)
+
+/** Latency distribution of one qualification run */
+typedef struct
+{
+    uint32_t BlockSize;
+    uint32_t Alignment;
+    uint32_t Minimum;
+    uint32_t Median;
+    uint32_t Percentile95;
+    uint32_t Maximum;
+    uint32_t Throughput;    /**< Bytes per second */
+} QualifyRun_T;
+
+/* local variables ********************************************************** */
+static QualifyRun_T QualifyRun[BLOCK_SIZES * ALIGNMENTS];
+
+/* global variables ********************************************************* */
+
+/* inline functions ********************************************************* */
+
+/* local functions ********************************************************** */
+
+/**
+ * @brief Sorts the latencies of a run in place, the run is small enough for an insertion sort.
+ */
+static void SortLatencies(uint32_t * latency, uint8_t count)
+{
+    for (uint8_t i = 1; i < count; i++)
+    {
+        uint32_t value = latency[i];
+        uint8_t j = i;
+        while ((j > 0U) && (latency[j - 1U] > value))
+        {
+            latency[j] = latency[j - 1U];
+            j--;
+        }
+        latency[j] = value;
+    }
+} /* SortLatencies */
+
+/**
+ * @brief Appends SDQUALIFY_WRITES blocks of a test pattern and records their latency distribution.
+ */
+static Retcode_T QualifyBlock(uint8_t * scratch, uint32_t blockSize, uint32_t alignment, uint32_t * fileOffset, QualifyRun_T * run)
+{
+    uint32_t latency[SDQUALIFY_WRITES];
+    uint32_t total = 0;
+
+    for (uint32_t i = 0; i < blockSize; i++)
+    {
+        scratch[i] = (uint8_t) (i + blockSize + alignment);
+    }
+
+    /* Start every run on a fresh sector, shifted by the alignment under test */
+    *fileOffset = ((*fileOffset + SDQUALIFY_MIN_BLOCK - 1UL) / SDQUALIFY_MIN_BLOCK) * SDQUALIFY_MIN_BLOCK + alignment;
+
+    Storage_Write_T writeCredentials =
+    {
+        .FileName = QUALIFY_FILE_NAME,
+        .WriteBuffer = scratch,
+        .BytesToWrite = blockSize,
+        .ActualBytesWritten = 0UL,
+        .Offset = 0UL,
+    };
+
+    Retcode_T retcode = RETCODE_OK;
+    for (uint8_t i = 0; (i < SDQUALIFY_WRITES) && (RETCODE_OK == retcode); i++)
+    {
+        writeCredentials.Offset = *fileOffset;
+        TickType_t start = xTaskGetTickCount();
+        retcode = Storage_Write(STORAGE_MEDIUM_SD_CARD, &writeCredentials);
+        latency[i] = (uint32_t) (xTaskGetTickCount() - start) * portTICK_PERIOD_MS;
+        total += latency[i];
+        *fileOffset += blockSize;
+    }
+
+    if (RETCODE_OK == retcode)
+    {
+        SortLatencies(latency, SDQUALIFY_WRITES);
+        run->BlockSize = blockSize;
+        run->Alignment = alignment;
+        run->Minimum = latency[0];
+        run->Median = latency[SDQUALIFY_WRITES / 2U];
+        run->Percentile95 = latency[(SDQUALIFY_WRITES * 95U) / 100U];
+        run->Maximum = latency[SDQUALIFY_WRITES - 1U];
+        run->Throughput = (blockSize * SDQUALIFY_WRITES * 1000UL) / ((0UL == total) ? 1UL : total);
+    }
+
+    return (retcode);
+} /* QualifyBlock */
+
+/**
+ * @brief Tells if a run is a better flush size than the best one so far: meeting the latency
+ * budget comes first, then the lower 95th percentile if both miss it, then the smaller block.
+ * With orientation records the logger writes about 450 B/s of "Q;" records plus the sensor and
+ * telemetry records, around 600 B/s, while a block meeting the budget sustains at least
+ * 2 * SDQUALIFY_MIN_BLOCK bytes per sample cycle. Any of them keeps up, and a smaller one holds
+ * fewer records in RAM, which are lost on power loss.
+ */
+static bool IsBetterRun(const QualifyRun_T * run, const QualifyRun_T * best)
+{
+    bool runMeetsBudget = (run->Percentile95 <= SDQUALIFY_MAX_LATENCY);
+    bool bestMeetsBudget = (best->Percentile95 <= SDQUALIFY_MAX_LATENCY);
+
+    if (runMeetsBudget != bestMeetsBudget)
+    {
+        return (runMeetsBudget);
+    }
+    if ((!runMeetsBudget) && (run->Percentile95 != best->Percentile95))
+    {
+        return (run->Percentile95 < best->Percentile95);
+    }
+    return (run->BlockSize < best->BlockSize);
+} /* IsBetterRun */
+
+/**
+ * @brief Buffer depth holding the records of a log writer stall: one block being written, one
+ * partially filled block and SDQUALIFY_CYCLE_BYTES for every sample cycle the stall overlaps.
+ */
+static uint32_t RequiredDepth(uint32_t blockSize, uint32_t stall)
+{
+    uint32_t cycles = 1UL + (stall / WRITEREAD_DELAY);
+    return (2UL + (((cycles * SDQUALIFY_CYCLE_BYTES) + blockSize - 1UL) / blockSize));
+} /* RequiredDepth */
+
+/**
+ * @brief Picks the flush size among the sector aligned runs, the logger only issues aligned
+ * flushes since every flush is a multiple of the sector size.
+ */
+static void SelectTuning(SdQualify_Tuning_T * tuning)
+{
+    const QualifyRun_T * best = NULL;
+
+    for (uint8_t i = 0; i < (BLOCK_SIZES * ALIGNMENTS); i++)
+    {
+        const QualifyRun_T * run = &QualifyRun[i];
+        if ((0UL != run->Alignment) || ((run->BlockSize * RequiredDepth(run->BlockSize, 0UL)) > SDQUALIFY_BUFFER_SIZE))
+        {
+            continue;
+        }
+        if ((NULL == best) || IsBetterRun(run, best))
+        {
+            best = run;
+        }
+    }
+
+    /* The log writer stalls while the application keeps sampling, size the buffer for the worst
+     * observed stall as far as it fits */
+    uint32_t depth = RequiredDepth(best->BlockSize, best->Maximum);
+    uint32_t maximumDepth = SDQUALIFY_BUFFER_SIZE / best->BlockSize;
+    if (depth > maximumDepth)
+    {
+        depth = maximumDepth;
+    }
+    tuning->FlushSize = best->BlockSize;
+    tuning->BufferDepth = (uint8_t) depth;
+} /* SelectTuning */
+
+/**
+ * @brief Writes the latency distribution of every run and the selected tuning to the report file.
+ */
+static Retcode_T WriteReport(const SdQualify_Tuning_T * tuning)
+{
+    char lineBuffer[LINE_BUFFER_SIZE];
+
+    Storage_Write_T writeCredentials =
+    {
+        .FileName = REPORT_FILE_NAME,
+        .WriteBuffer = (uint8_t *) lineBuffer,
+        .BytesToWrite = 0UL,
+        .ActualBytesWritten = 0UL,
+        .Offset = 0UL,
+    };
+
+    Retcode_T retcode = RETCODE_OK;
+    for (uint8_t i = 0; (i <= (BLOCK_SIZES * ALIGNMENTS)) && (RETCODE_OK == retcode); i++)
+    {
+        int32_t length = 0;
+        if (0U == i)
+        {
+            length = snprintf(lineBuffer, LINE_BUFFER_SIZE, "# flush %lu; depth %u\r\n",
+                        (unsigned long) tuning->FlushSize,
+                        (unsigned int) tuning->BufferDepth);
+        }
+        else
+        {
+            const QualifyRun_T * run = &QualifyRun[i - 1U];
+            length = snprintf(lineBuffer, LINE_BUFFER_SIZE, "%lu; %lu; %lu; %lu; %lu; %lu; %lu\r\n",
+                        (unsigned long) run->BlockSize,
+                        (unsigned long) run->Alignment,
+                        (unsigned long) run->Minimum,
+                        (unsigned long) run->Median,
+                        (unsigned long) run->Percentile95,
+                        (unsigned long) run->Maximum,
+                        (unsigned long) run->Throughput);
+        }
+        writeCredentials.BytesToWrite = length;
+        retcode = Storage_Write(STORAGE_MEDIUM_SD_CARD, &writeCredentials);
+        writeCredentials.Offset += writeCredentials.ActualBytesWritten;
+    }
+
+    return (retcode);
+} /* WriteReport */
+
+/* global functions ********************************************************* */
+
+/** Refer interface header for description */
+Retcode_T SdQualify_Run(uint8_t * scratch, uint32_t size, SdQualify_Tuning_T * tuning)
+{
+    if ((NULL == scratch) || (NULL == tuning))
+    {
+        return (RETCODE(RETCODE_SEVERITY_ERROR, RETCODE_NULL_POINTER));
+    }
+    if (size < SDQUALIFY_MAX_BLOCK)
+    {
+        return (RETCODE(RETCODE_SEVERITY_ERROR, RETCODE_INVALID_PARAM));
+    }
+
+    /* Storage_Write() neither truncates nor recreates a file: start from empty files, so the runs
+     * allocate new clusters like the log does and no bytes of an earlier qualification remain.
+     * Deleting fails if the card was never qualified, which is fine */
+    (void) Storage_Delete(STORAGE_MEDIUM_SD_CARD, QUALIFY_FILE_NAME);
+    (void) Storage_Delete(STORAGE_MEDIUM_SD_CARD, REPORT_FILE_NAME);
+    (void) Storage_Delete(STORAGE_MEDIUM_SD_CARD, TUNING_FILE_NAME);
+
+    Retcode_T retcode = RETCODE_OK;
+    uint32_t fileOffset = 0;
+    uint8_t run = 0;
+    for (uint32_t blockSize = SDQUALIFY_MIN_BLOCK; (blockSize <= SDQUALIFY_MAX_BLOCK) && (RETCODE_OK == retcode); blockSize *= 2UL)
+    {
+        retcode = QualifyBlock(scratch, blockSize, 0UL, &fileOffset, &QualifyRun[run++]);
+        if (RETCODE_OK == retcode) retcode = QualifyBlock(scratch, blockSize, SDQUALIFY_MISALIGNMENT, &fileOffset, &QualifyRun[run++]);
+    }
+
+    if (RETCODE_OK == retcode)
+    {
+        SelectTuning(tuning);
+        for (uint8_t i = 0; i < run; i++)
+        {
+            printf("[SD QUALIFY] %4lu B @+%3lu: min %lu, p50 %lu, p95 %lu, max %lu ms, %lu B/s\r\n",
+                    (unsigned long) QualifyRun[i].BlockSize,
+                    (unsigned long) QualifyRun[i].Alignment,
+                    (unsigned long) QualifyRun[i].Minimum,
+                    (unsigned long) QualifyRun[i].Median,
+                    (unsigned long) QualifyRun[i].Percentile95,
+                    (unsigned long) QualifyRun[i].Maximum,
+                    (unsigned long) QualifyRun[i].Throughput);
+        }
+        printf("[SD QUALIFY] Flush size %lu, buffer depth %u\r\n", (unsigned long) tuning->FlushSize, (unsigned int) tuning->BufferDepth);
+        retcode = WriteReport(tuning);
+    }
+
+    if (RETCODE_OK == retcode)
+    {
+        char tuningBuffer[LINE_BUFFER_SIZE];
+        int32_t length = snprintf(tuningBuffer, LINE_BUFFER_SIZE, "%lu\r\n%u\r\n",
+                            (unsigned long) tuning->FlushSize,
+                            (unsigned int) tuning->BufferDepth);
+
+        Storage_Write_T writeCredentials =
+        {
+            .FileName = TUNING_FILE_NAME,
+            .WriteBuffer = (uint8_t *) tuningBuffer,
+            .BytesToWrite = length,
+            .ActualBytesWritten = 0UL,
+            .Offset = 0UL,
+        };
+        retcode = Storage_Write(STORAGE_MEDIUM_SD_CARD, &writeCredentials);
+    }
+
+    return (retcode);
+} /* SdQualify_Run */
+
+/** Refer interface header for description */
+Retcode_T SdQualify_Load(SdQualify_Tuning_T * tuning)
+{
+    if (NULL == tuning)
+    {
+        return (RETCODE(RETCODE_SEVERITY_ERROR, RETCODE_NULL_POINTER));
+    }
+
+    tuning->FlushSize = SDQUALIFY_DEFAULT_FLUSH;
+    tuning->BufferDepth = SDQUALIFY_DEFAULT_DEPTH;
+
+    char readBuffer[LINE_BUFFER_SIZE];
+    Storage_Read_T readCredentials =
+    {
+        .FileName = TUNING_FILE_NAME,
+        .ReadBuffer = (uint8_t *) readBuffer,
+        .BytesToRead = LINE_BUFFER_SIZE - 1UL,
+        .ActualBytesRead = 0UL,
+        .Offset = 0UL,
+    };
+
+    Retcode_T retcode = Storage_Read(STORAGE_MEDIUM_SD_CARD, &readCredentials);
+    if (RETCODE_OK == retcode)
+    {
+        unsigned long flushSize = 0;
+        unsigned int bufferDepth = 0;
+        readBuffer[readCredentials.ActualBytesRead] = '\0';
+        if ((2 != sscanf(readBuffer, "%lu %u", &flushSize, &bufferDepth))
+                || (flushSize < SDQUALIFY_MIN_BLOCK) || (flushSize > SDQUALIFY_MAX_BLOCK) || (0UL != (flushSize % SDQUALIFY_MIN_BLOCK))
+                || (0U == bufferDepth) || ((flushSize * bufferDepth) > SDQUALIFY_BUFFER_SIZE))
+        {
+            retcode = RETCODE(RETCODE_SEVERITY_WARNING, RETCODE_INVALID_PARAM);
+        }
+        else
+        {
+            tuning->FlushSize = (uint32_t) flushSize;
+            tuning->BufferDepth = (uint8_t) bufferDepth;
+        }
+    }
+
+    return (retcode);
+} /* SdQualify_Load */
+
+/**@} */
+/** ************************************************************************* */
@@ -0,0 +1,63 @@
+/* header definition ******************************************************** */
+#ifndef SDQUALIFY_H_
+#define SDQUALIFY_H_
+
+/* local interface declaration ********************************************** */
+#include "XDK_Utils.h"
+#include "AppController.h"
+
+/* local type and macro definitions */
+#define SDQUALIFY_LONG_PRESS        UINT32_C(3000)  /**< Millisecond press of Button 1 starting the qualification */
+#define SDQUALIFY_WRITES            UINT8_C(32)     /**< Timed writes per block size and alignment */
+#define SDQUALIFY_MIN_BLOCK         UINT32_C(512)   /**< Smallest qualified block size, one SD card sector */
+#define SDQUALIFY_MAX_BLOCK         UINT32_C(4096)  /**< Largest qualified block size */
+#define SDQUALIFY_MISALIGNMENT      UINT32_C(256)   /**< Offset of the unaligned runs from the sector boundary */
+#define SDQUALIFY_BUFFER_SIZE       UINT32_C(8192)  /**< RAM log buffer, flush size * buffer depth never exceeds it */
+#define SDQUALIFY_MAX_LATENCY       (WRITEREAD_DELAY / 2) /**< Millisecond 95th percentile budget of one flush */
+#define SDQUALIFY_CYCLE_BYTES       UINT32_C(1536)  /**< Upper bound of the log bytes one sample cycle adds, checked by AppController.c */
+#define SDQUALIFY_DEFAULT_FLUSH     UINT32_C(512)   /**< Flush size used when the card was never qualified */
+#define SDQUALIFY_DEFAULT_DEPTH     UINT8_C(5)      /**< Buffer depth used when the card was never qualified, SDQUALIFY_DEFAULT_FLUSH without stalls */
+
+/** Write batching parameters of the logger */
+typedef struct
+{
+    uint32_t FlushSize;     /**< Bytes written to the card at once, a multiple of the sector size */
+    uint8_t BufferDepth;    /**< Flush blocks buffered in RAM while the log writer fails or stalls */
+} SdQualify_Tuning_T;
+
+/* local function prototype declarations */
+
+/* local inline function definitions */
+
+/**
+ * @brief Qualifies the SD card and persists the best tuning.
+ *
+ * Writes test patterns through Storage_Write() to "qual.xdk" at every block size from
+ * SDQUALIFY_MIN_BLOCK to SDQUALIFY_MAX_BLOCK, sector aligned and misaligned, and times each write.
+ * The latency distribution of every run is written to "qual.csv". The smallest flush size whose
+ * 95th percentile stays within SDQUALIFY_MAX_LATENCY (or the lowest 95th percentile if none does)
+ * is stored in "tune.xdk", with a buffer depth holding SDQUALIFY_CYCLE_BYTES for every sample
+ * cycle of the worst observed stall of the log writer. The files of an earlier qualification are deleted first.
+ *
+ * @param[in] scratch Buffer for the test pattern, at least SDQUALIFY_MAX_BLOCK bytes
+ *
+ * @param[in] size Size of the scratch buffer
+ *
+ * @param[out] tuning Selected tuning
+ *
+ * @retval RETCODE_OK on success, the Storage_Write() error otherwise
+ */
+Retcode_T SdQualify_Run(uint8_t * scratch, uint32_t size, SdQualify_Tuning_T * tuning);
+
+/**
+ * @brief Loads the tuning stored by SdQualify_Run(), or the defaults if the card was not qualified.
+ *
+ * @param[out] tuning Loaded tuning
+ *
+ * @retval RETCODE_OK if the stored tuning was loaded, an error if the defaults are used
+ */
+Retcode_T SdQualify_Load(SdQualify_Tuning_T * tuning);
+
+#endif /* SDQUALIFY_H_ */
+
+/** ************************************************************************* */
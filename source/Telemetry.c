@@ -0,0 +1,265 @@
+/**
+ * @ingroup APPS_LIST
+ *
+ * @defgroup TELEMETRY Telemetry
+ * @{
+ *
+ * @brief Run-time telemetry of the datalogger.
+ *
+ * @details FreeRTOS run-time stats are clocked by the Cortex-M3 DWT cycle counter, which
+ * FreeRTOSConfig.h starts with the scheduler and which costs a single register read per context
+ * switch. Telemetry_GetRecord() turns the counter deltas since the previous record into the CPU
+ * share of every task, and adds the command processor queue depth, the SD card write retry/failure
+ * counters and the cycles of the orientation filter, so saturation can be spotted in the log before
+ * data is lost.
+ *
+ * @file
+ **/
+
+/* module includes ********************************************************** */
+
+/* own header files */
+#include "XdkAppInfo.h"
+#undef BCDS_MODULE_ID  /* Module ID define before including Basics package*/
+#define BCDS_MODULE_ID XDK_APP_MODULE_ID_TELEMETRY
+
+/* own header files */
+#include "Telemetry.h"
+
+/* system header files */
+#include <stdio.h>
+
+/* additional interface header files */
+#include "em_device.h"
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+
+/* constant definitions ***************************************************** */
+#define PERMILLE                    UINT32_C(1000)
+#define COUNTER_WRAP_PERIOD         ((uint32_t) ((UINT64_C(0xFFFFFFFF) * 1000U) / SystemCoreClock)) /**< Milliseconds until the DWT cycle counter wraps */
+
+/* local variables ********************************************************** */
+static CmdProcessor_T * TelemetryCmdProcessor = NULL;/**< Command processor whose queue depth is reported */
+
+static TaskStatus_t TaskStatus[TELEMETRY_MAX_TASKS];/**< Snapshot of the task states, kept static to spare the caller stack */
+
+static UBaseType_t PreviousTaskNumber[TELEMETRY_MAX_TASKS];/**< Task numbers of the previous snapshot */
+static uint32_t PreviousTaskCounter[TELEMETRY_MAX_TASKS];/**< Run-time counters of the previous snapshot */
+static UBaseType_t PreviousTaskCount = 0;
+static uint32_t PreviousTotalCounter = 0;
+static TickType_t PreviousTick = 0;/**< Tick count of the previous snapshot */
+static bool PreviousValid = false;/**< A previous snapshot exists */
+
+/* global variables ********************************************************* */
+static uint32_t sdRetryCount = 0;
+static uint32_t sdFailureCount = 0;
+static uint32_t fusionCount = 0;
+static uint32_t fusionCycles = 0;
+static uint32_t fusionMaxCycles = 0;
+
+/* inline functions ********************************************************* */
+
+/* local functions ********************************************************** */
+
+/**
+ * @brief Returns the run-time counter of a task at the previous snapshot, or zero for a new task.
+ */
+static uint32_t PreviousCounterOf(UBaseType_t taskNumber)
+{
+    for (UBaseType_t i = 0; i < PreviousTaskCount; i++)
+    {
+        if (PreviousTaskNumber[i] == taskNumber)
+        {
+            return (PreviousTaskCounter[i]);
+        }
+    }
+    return (0UL);
+} /* PreviousCounterOf */
+
+/**
+ * @brief Keeps the task snapshot in TaskStatus as base of the next record and restarts the fusion statistics.
+ */
+static void StoreSnapshot(UBaseType_t taskCount, uint32_t totalCounter)
+{
+    for (UBaseType_t i = 0; i < taskCount; i++)
+    {
+        PreviousTaskNumber[i] = TaskStatus[i].xTaskNumber;
+        PreviousTaskCounter[i] = TaskStatus[i].ulRunTimeCounter;
+    }
+    PreviousTaskCount = taskCount;
+    PreviousTotalCounter = totalCounter;
+    PreviousTick = xTaskGetTickCount();
+    PreviousValid = true;
+    taskENTER_CRITICAL();
+    fusionCount = 0;
+    fusionCycles = 0;
+    fusionMaxCycles = 0;
+    taskEXIT_CRITICAL();
+} /* StoreSnapshot */
+
+/**
+ * @brief Converts a counter delta into per mille of the record period.
+ */
+static uint32_t ToPermille(uint32_t delta, uint32_t totalDelta)
+{
+    if (0UL == totalDelta)
+    {
+        return (0UL);
+    }
+    return ((uint32_t) (((uint64_t) delta * PERMILLE) / totalDelta));
+} /* ToPermille */
+
+/* global functions ********************************************************* */
+
+/** Refer interface header for description */
+Retcode_T Telemetry_Setup(CmdProcessor_T * cmdProcessor)
+{
+    if (NULL == cmdProcessor)
+    {
+        return (RETCODE(RETCODE_SEVERITY_ERROR, RETCODE_NULL_POINTER));
+    }
+    TelemetryCmdProcessor = cmdProcessor;
+    return (RETCODE_OK);
+} /* Telemetry_Setup */
+
+/** Refer interface header for description */
+void Telemetry_CountSdRetry(void)
+{
+    sdRetryCount++;
+} /* Telemetry_CountSdRetry */
+
+/** Refer interface header for description */
+void Telemetry_CountSdFailure(uint32_t records)
+{
+    sdFailureCount += records;
+} /* Telemetry_CountSdFailure */
+
+/** Refer interface header for description */
+void Telemetry_CountFusionCycles(uint32_t cycles)
+{
+    taskENTER_CRITICAL();
+    fusionCount++;
+    fusionCycles += cycles;
+    if (cycles > fusionMaxCycles) fusionMaxCycles = cycles;
+    taskEXIT_CRITICAL();
+} /* Telemetry_CountFusionCycles */
+
+/** Refer interface header for description */
+Retcode_T Telemetry_StartPeriod(void)
+{
+    uint32_t totalCounter = 0;
+    UBaseType_t taskCount = uxTaskGetSystemState(TaskStatus, TELEMETRY_MAX_TASKS, &totalCounter);
+    if (0U == taskCount)
+    {
+        /* More tasks are running than TELEMETRY_MAX_TASKS can hold */
+        return (RETCODE(RETCODE_SEVERITY_WARNING, RETCODE_OUT_OF_RESOURCES));
+    }
+    StoreSnapshot(taskCount, totalCounter);
+    return (RETCODE_OK);
+} /* Telemetry_StartPeriod */
+
+/** Refer interface header for description */
+Retcode_T Telemetry_GetRecord(char * buffer, uint32_t size, uint32_t timestamp, uint32_t * length)
+{
+    if ((NULL == buffer) || (NULL == length))
+    {
+        return (RETCODE(RETCODE_SEVERITY_ERROR, RETCODE_NULL_POINTER));
+    }
+    *length = 0;
+
+    uint32_t totalCounter = 0;
+    UBaseType_t taskCount = uxTaskGetSystemState(TaskStatus, TELEMETRY_MAX_TASKS, &totalCounter);
+    if (0U == taskCount)
+    {
+        /* More tasks are running than TELEMETRY_MAX_TASKS can hold */
+        return (RETCODE(RETCODE_SEVERITY_WARNING, RETCODE_OUT_OF_RESOURCES));
+    }
+
+    if ((!PreviousValid) || (((xTaskGetTickCount() - PreviousTick) * portTICK_PERIOD_MS) >= COUNTER_WRAP_PERIOD))
+    {
+        /* Without a snapshot less than one counter wrap old the deltas are meaningless, skip the record */
+        StoreSnapshot(taskCount, totalCounter);
+        return (RETCODE_OK);
+    }
+
+    /* Unsigned deltas stay correct across a single wrap of the 32 bit cycle counter */
+    uint32_t totalDelta = totalCounter - PreviousTotalCounter;
+    TaskHandle_t idleHandle = xTaskGetIdleTaskHandle();
+    uint32_t idlePermille = 0;
+
+    for (UBaseType_t i = 0; i < taskCount; i++)
+    {
+        if (TaskStatus[i].xHandle == idleHandle)
+        {
+            idlePermille = ToPermille(TaskStatus[i].ulRunTimeCounter - PreviousCounterOf(TaskStatus[i].xTaskNumber), totalDelta);
+        }
+    }
+
+    int32_t written = snprintf(buffer, size, "T; %ld; idle %lu.%lu",
+                        (long int) timestamp,
+                        (unsigned long) (idlePermille / 10UL),
+                        (unsigned long) (idlePermille % 10UL));
+
+    for (UBaseType_t i = 0; (i < taskCount) && (written > 0) && ((uint32_t) written < size); i++)
+    {
+        if (TaskStatus[i].xHandle == idleHandle)
+        {
+            continue;
+        }
+        uint32_t permille = ToPermille(TaskStatus[i].ulRunTimeCounter - PreviousCounterOf(TaskStatus[i].xTaskNumber), totalDelta);
+        written += snprintf(&buffer[written], size - written, "; %s %lu.%lu",
+                        TaskStatus[i].pcTaskName,
+                        (unsigned long) (permille / 10UL),
+                        (unsigned long) (permille % 10UL));
+    }
+
+    if ((written > 0) && ((uint32_t) written < size))
+    {
+        UBaseType_t queueDepth = 0;
+        UBaseType_t queueLength = 0;
+        if (NULL != TelemetryCmdProcessor)
+        {
+            queueDepth = uxQueueMessagesWaiting(TelemetryCmdProcessor->queue);
+            queueLength = queueDepth + uxQueueSpacesAvailable(TelemetryCmdProcessor->queue);
+        }
+        written += snprintf(&buffer[written], size - written, "; q %lu/%lu; retry %lu; fail %lu",
+                        (unsigned long) queueDepth,
+                        (unsigned long) queueLength,
+                        (unsigned long) sdRetryCount,
+                        (unsigned long) sdFailureCount);
+    }
+
+    uint32_t fusionAverage = 0;
+    uint32_t fusionMax = 0;
+    taskENTER_CRITICAL();
+    if (fusionCount > 0UL)
+    {
+        fusionAverage = fusionCycles / fusionCount;
+        fusionMax = fusionMaxCycles;
+    }
+    taskEXIT_CRITICAL();
+    if ((fusionMax > 0UL) && (written > 0) && ((uint32_t) written < size))
+    {
+        written += snprintf(&buffer[written], size - written, "; fusion %lu/%lu",
+                        (unsigned long) fusionAverage,
+                        (unsigned long) fusionMax);
+    }
+    if ((written > 0) && ((uint32_t) written < size))
+    {
+        written += snprintf(&buffer[written], size - written, "\n");
+    }
+
+    if ((written <= 0) || ((uint32_t) written >= size))
+    {
+        return (RETCODE(RETCODE_SEVERITY_WARNING, RETCODE_OUT_OF_RESOURCES));
+    }
+
+    StoreSnapshot(taskCount, totalCounter);
+
+    *length = (uint32_t) written;
+    return (RETCODE_OK);
+} /* Telemetry_GetRecord */
+
+/**@} */
+/** ************************************************************************* */
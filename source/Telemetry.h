@@ -0,0 +1,76 @@
+/* header definition ******************************************************** */
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+/* local interface declaration ********************************************** */
+#include "XDK_Utils.h"
+#include "BCDS_CmdProcessor.h"
+
+/* local type and macro definitions */
+#define TELEMETRY_INTERVAL          UINT32_C(10000) /**< Millisecond interval between telemetry records, must stay below the ~89 s DWT cycle counter wrap at 48 MHz */
+#define TELEMETRY_MAX_TASKS         UINT8_C(12)     /**< Maximum number of RTOS tasks tracked per telemetry record */
+
+/* local function prototype declarations */
+
+/* local inline function definitions */
+
+/**
+ * @brief Registers the command processor whose queue depth is reported in the telemetry record.
+ *
+ * @param[in] cmdProcessor Handle of the main command processor
+ *
+ * @retval RETCODE_OK on success, RETCODE_NULL_POINTER if the handle is NULL
+ */
+Retcode_T Telemetry_Setup(CmdProcessor_T * cmdProcessor);
+
+/**
+ * @brief Counts a failed SD card flush, its records stay buffered and are retried when the log
+ * writer task wakes up next.
+ */
+void Telemetry_CountSdRetry(void);
+
+/**
+ * @brief Counts records dropped because the SD card kept failing until the log buffer was full.
+ *
+ * @param[in] records Number of dropped records
+ */
+void Telemetry_CountSdFailure(uint32_t records);
+
+/**
+ * @brief Accounts the cycles of one orientation filter update, reported as average and maximum.
+ *
+ * @param[in] cycles DWT cycles spent in Fusion_Update()
+ */
+void Telemetry_CountFusionCycles(uint32_t cycles);
+
+/**
+ * @brief Takes the task snapshot the next telemetry record is measured against.
+ * Called when logging starts, so the first record of a session covers the session only.
+ *
+ * @retval RETCODE_OK on success, RETCODE_OUT_OF_RESOURCES if more than TELEMETRY_MAX_TASKS tasks run
+ */
+Retcode_T Telemetry_StartPeriod(void);
+
+/**
+ * @brief Formats a telemetry record with the per-task CPU share since the previous call.
+ *
+ * Record layout: "T; <ms>; idle <%>; <task> <%>; ...; q <depth>/<length>; retry <n>; fail <n>[; fusion <avg>/<max>]"
+ * The fusion cycles are only present if filter updates were counted since the previous record.
+ * Without a snapshot from Telemetry_StartPeriod() or a previous record, or if that snapshot is
+ * older than one wrap of the cycle counter, no record is formatted and a new snapshot is taken.
+ *
+ * @param[out] buffer Destination for the record text
+ *
+ * @param[in] size Size of the destination buffer
+ *
+ * @param[in] timestamp Session time of the record in milliseconds
+ *
+ * @param[out] length Number of characters written into the buffer, 0 if the record was skipped
+ *
+ * @retval RETCODE_OK on success
+ */
+Retcode_T Telemetry_GetRecord(char * buffer, uint32_t size, uint32_t timestamp, uint32_t * length);
+
+#endif /* TELEMETRY_H_ */
+
+/** ************************************************************************* */
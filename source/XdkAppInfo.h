@@ -22,6 +22,16 @@
 /**< Application controller task stack size */
 #define TASK_STACK_SIZE_APP_CONTROLLER              (UINT32_C(1200))
 
+/**< Log writer task priority, below the application so SD card writes never delay a sample */
+#define TASK_PRIO_LOG_WRITER                        (UINT32_C(2))
+/**< Log writer task stack size, the FAT file system needs most of it */
+#define TASK_STACK_SIZE_LOG_WRITER                  (UINT32_C(1000))
+
+/**< Orientation task priority, above the application to keep the sample rate */
+#define TASK_PRIO_ORIENTATION                       (UINT32_C(4))
+/**< Orientation task stack size */
+#define TASK_STACK_SIZE_ORIENTATION                 (UINT32_C(400))
+
 /**
  * @brief BCDS_APP_MODULE_ID for Application C module of XDK
  * @info  usage:
@@ -32,6 +42,10 @@ enum XDK_App_ModuleID_E
 {
     XDK_APP_MODULE_ID_MAIN = XDK_COMMON_ID_OVERFLOW,
     XDK_APP_MODULE_ID_APP_CONTROLLER,
+    XDK_APP_MODULE_ID_TELEMETRY,
+    XDK_APP_MODULE_ID_DEADBAND,
+    XDK_APP_MODULE_ID_SD_QUALIFY,
+    XDK_APP_MODULE_ID_ORIENTATION,
 
 /* Define next module ID here */
 };
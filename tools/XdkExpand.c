@@ -0,0 +1,88 @@
+/**
+ * @file
+ * @brief Expands a session file written with the deadband filter into complete sample rows.
+ *
+ * @details Each "D;" record is turned into a full "<ms>; <accel_x>; ...; <battery>" row, holding the
+ * channels missing in the record at their previous value (step-hold), so tools expecting the
+ * original row layout can read the session. Telemetry records are dropped unless -t is given,
+ * orientation records unless -q is given.
+ *
+ * Usage:
+ *   xdk_expand [-t] [-q] data_##.csv > full.csv
+ */
+#include "XdkLog.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+int main(int argc, char ** argv)
+{
+    int keepTelemetry = 0;
+    int keepOrientation = 0;
+    int option;
+
+    while (-1 != (option = getopt(argc, argv, "tq")))
+    {
+        if ('t' == option)
+        {
+            keepTelemetry = 1;
+        }
+        else if ('q' == option)
+        {
+            keepOrientation = 1;
+        }
+        else
+        {
+            fprintf(stderr, "usage: xdk_expand [-t] [-q] data_##.csv > full.csv\n");
+            return (EXIT_FAILURE);
+        }
+    }
+    if (optind + 1 != argc)
+    {
+        fprintf(stderr, "usage: xdk_expand [-t] [-q] data_##.csv > full.csv\n");
+        return (EXIT_FAILURE);
+    }
+
+    FILE * file = (0 == strcmp(argv[optind], "-")) ? stdin : fopen(argv[optind], "r");
+    if (NULL == file)
+    {
+        fprintf(stderr, "xdk_expand: cannot open %s: %s\n", argv[optind], strerror(errno));
+        return (EXIT_FAILURE);
+    }
+
+    char line[XDKLOG_LINE_SIZE];
+    char row[XDKLOG_LINE_SIZE];
+    XdkLog_Record_T record;
+    XdkLog_InitRecord(&record);
+    while (NULL != fgets(line, sizeof(line), file))
+    {
+        switch (XdkLog_ParseLine(line, &record))
+        {
+        case XDKLOG_RECORD_SAMPLE:
+            XdkLog_FormatSample(&record, row, sizeof(row));
+            puts(row);
+            break;
+        case XDKLOG_RECORD_TELEMETRY:
+            if (keepTelemetry)
+            {
+                fputs(line, stdout);
+            }
+            break;
+        case XDKLOG_RECORD_ORIENTATION:
+            if (keepOrientation)
+            {
+                fputs(line, stdout);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    if (stdin != file)
+    {
+        fclose(file);
+    }
+    return (EXIT_SUCCESS);
+}
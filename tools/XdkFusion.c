@@ -0,0 +1,404 @@
+/**
+ * @file
+ * @brief Host reference for the fixed-point orientation filter (source/Fusion.c).
+ *
+ * @details A synthetic motion is integrated into the true orientation and turned into quantized
+ * accelerometer, gyroscope and magnetometer samples in the units of the XDK drivers. The samples
+ * are fused by the fixed-point filter and by the floating-point Mahony reference, and the angle
+ * errors between the two and against the true orientation are reported. A static check then
+ * shows the error left by the sensor resolution alone, followed by the time per update. The exit
+ * code is non-zero if the fixed-point filter strays from the reference by more than the tolerance.
+ *
+ * Usage:
+ *   xdk_fusion [-s seconds] [-n updates] [-t tolerance_deg]
+ */
+#include "Fusion.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_SECONDS             120.0
+#define DEFAULT_UPDATES             2000000UL
+#define DEFAULT_TOLERANCE           0.5     /**< Maximum fixed-point vs reference angle error [deg] */
+#define WARM_UP                     10.0    /**< Seconds of convergence excluded from the statistics */
+#define SUBSTEPS                    16      /**< Integration steps of the true motion per sample */
+#define MAG_NORTH                   20.0    /**< Horizontal earth field [uT] */
+#define MAG_DOWN                    (-40.0) /**< Vertical earth field [uT] */
+#define GYRO_BIAS                   300.0   /**< Gyroscope bias of the simulated sensor [mdeg/s] */
+#define STATIC_POSES                64      /**< Orientations of the static check */
+#define STATIC_SECONDS              60.0    /**< Convergence time per static pose */
+#define PI                          3.14159265358979323846
+#define RAD_TO_DEG                  (180.0 / PI)
+
+/** Floating-point Mahony reference filter */
+typedef struct
+{
+    double Q[4];
+    double Integral[3];
+} Reference_T;
+
+static void QuaternionMultiply(const double * a, const double * b, double * result)
+{
+    result[0] = a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3];
+    result[1] = a[0] * b[1] + a[1] * b[0] + a[2] * b[3] - a[3] * b[2];
+    result[2] = a[0] * b[2] - a[1] * b[3] + a[2] * b[0] + a[3] * b[1];
+    result[3] = a[0] * b[3] + a[1] * b[2] - a[2] * b[1] + a[3] * b[0];
+}
+
+static void QuaternionNormalize(double * q)
+{
+    double norm = sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    for (int i = 0; i < 4; i++)
+    {
+        q[i] /= norm;
+    }
+}
+
+/**
+ * @brief Rotates an earth frame vector into the sensor frame of orientation q.
+ */
+static void EarthToSensor(const double * q, const double * earth, double * sensor)
+{
+    double conjugate[4] = { q[0], -q[1], -q[2], -q[3] };
+    double vector[4] = { 0.0, earth[0], earth[1], earth[2] };
+    double temporary[4];
+    double result[4];
+    QuaternionMultiply(conjugate, vector, temporary);
+    QuaternionMultiply(temporary, q, result);
+    sensor[0] = result[1];
+    sensor[1] = result[2];
+    sensor[2] = result[3];
+}
+
+/**
+ * @brief Angle between two orientations [deg].
+ */
+static double AngleBetween(const double * a, const double * b)
+{
+    double dot = fabs(a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3]);
+    return (2.0 * acos((dot > 1.0) ? 1.0 : dot) * RAD_TO_DEG);
+}
+
+/**
+ * @brief Angular rate of the synthetic motion in the sensor frame [rad/s]: slow swings on all axes
+ * with faster turns around the vertical axis.
+ */
+static void MotionRate(double time, double * rate)
+{
+    rate[0] = 0.6 * sin(0.7 * time) + 0.3 * sin(2.3 * time);
+    rate[1] = 0.5 * cos(0.5 * time) + 0.2 * sin(3.1 * time + 1.0);
+    rate[2] = 1.2 * sin(0.23 * time) + 0.4 * cos(1.7 * time);
+}
+
+static void ReferenceInit(Reference_T * reference)
+{
+    reference->Q[0] = 1.0;
+    reference->Q[1] = 0.0;
+    reference->Q[2] = 0.0;
+    reference->Q[3] = 0.0;
+    reference->Integral[0] = 0.0;
+    reference->Integral[1] = 0.0;
+    reference->Integral[2] = 0.0;
+}
+
+/**
+ * @brief Mahony AHRS update in double precision, the algorithm Fusion_Update() implements.
+ */
+static void ReferenceUpdate(Reference_T * reference, const Fusion_Sample_T * sample)
+{
+    double * q = reference->Q;
+    double dt = 1.0 / FUSION_RATE;
+    double gx = sample->Gyro[0] * (PI / 180000.0);
+    double gy = sample->Gyro[1] * (PI / 180000.0);
+    double gz = sample->Gyro[2] * (PI / 180000.0);
+    double ax = sample->Accel[0];
+    double ay = sample->Accel[1];
+    double az = sample->Accel[2];
+    double mx = sample->Mag[0];
+    double my = sample->Mag[1];
+    double mz = sample->Mag[2];
+    double norm = sqrt(ax * ax + ay * ay + az * az);
+
+    if (norm > 0.0)
+    {
+        ax /= norm;
+        ay /= norm;
+        az /= norm;
+
+        double halfVx = q[1] * q[3] - q[0] * q[2];
+        double halfVy = q[0] * q[1] + q[2] * q[3];
+        double halfVz = q[0] * q[0] - 0.5 + q[3] * q[3];
+        double halfEx = ay * halfVz - az * halfVy;
+        double halfEy = az * halfVx - ax * halfVz;
+        double halfEz = ax * halfVy - ay * halfVx;
+
+        norm = sqrt(mx * mx + my * my + mz * mz);
+        if (norm > 0.0)
+        {
+            mx /= norm;
+            my /= norm;
+            mz /= norm;
+            double hx = 2.0 * (mx * (0.5 - q[2] * q[2] - q[3] * q[3]) + my * (q[1] * q[2] - q[0] * q[3]) + mz * (q[1] * q[3] + q[0] * q[2]));
+            double hy = 2.0 * (mx * (q[1] * q[2] + q[0] * q[3]) + my * (0.5 - q[1] * q[1] - q[3] * q[3]) + mz * (q[2] * q[3] - q[0] * q[1]));
+            double bx = sqrt(hx * hx + hy * hy);
+            double bz = 2.0 * (mx * (q[1] * q[3] - q[0] * q[2]) + my * (q[2] * q[3] + q[0] * q[1]) + mz * (0.5 - q[1] * q[1] - q[2] * q[2]));
+            double halfWx = bx * (0.5 - q[2] * q[2] - q[3] * q[3]) + bz * (q[1] * q[3] - q[0] * q[2]);
+            double halfWy = bx * (q[1] * q[2] - q[0] * q[3]) + bz * (q[0] * q[1] + q[2] * q[3]);
+            double halfWz = bx * (q[0] * q[2] + q[1] * q[3]) + bz * (0.5 - q[1] * q[1] - q[2] * q[2]);
+            halfEx += my * halfWz - mz * halfWy;
+            halfEy += mz * halfWx - mx * halfWz;
+            halfEz += mx * halfWy - my * halfWx;
+        }
+
+        if (FUSION_TWO_KI > 0.0)
+        {
+            reference->Integral[0] += FUSION_TWO_KI * halfEx * dt;
+            reference->Integral[1] += FUSION_TWO_KI * halfEy * dt;
+            reference->Integral[2] += FUSION_TWO_KI * halfEz * dt;
+            gx += reference->Integral[0];
+            gy += reference->Integral[1];
+            gz += reference->Integral[2];
+        }
+        gx += FUSION_TWO_KP * halfEx;
+        gy += FUSION_TWO_KP * halfEy;
+        gz += FUSION_TWO_KP * halfEz;
+    }
+
+    gx *= 0.5 * dt;
+    gy *= 0.5 * dt;
+    gz *= 0.5 * dt;
+    double qa = q[0];
+    double qb = q[1];
+    double qc = q[2];
+    q[0] += -qb * gx - qc * gy - q[3] * gz;
+    q[1] += qa * gx + qc * gz - q[3] * gy;
+    q[2] += qa * gy - qb * gz + q[3] * gx;
+    q[3] += qa * gz + qb * gy - qc * gx;
+    QuaternionNormalize(q);
+}
+
+static int32_t Quantize(double value)
+{
+    return ((int32_t) lround(value));
+}
+
+/**
+ * @brief Lets the fixed-point filter converge on a set of static poses without gyro bias, so the
+ * remaining error is the one of the quantized accelerometer and magnetometer samples.
+ *
+ * @return Largest angle error against the true pose [deg]
+ */
+static double StaticError(void)
+{
+    const double gravity[3] = { 0.0, 0.0, 1000.0 };
+    const double field[3] = { MAG_NORTH, 0.0, MAG_DOWN };
+    double maximum = 0.0;
+
+    for (int pose = 0; pose < STATIC_POSES; pose++)
+    {
+        /* Headings all around, tilted up to 40 degrees */
+        double yaw = 2.0 * PI * (pose + 0.37) / STATIC_POSES;
+        double tilt = 0.7 * sin(1.3 * pose);
+        double qYaw[4] = { cos(yaw / 2.0), 0.0, 0.0, sin(yaw / 2.0) };
+        double qTilt[4] = { cos(tilt / 2.0), sin(tilt / 2.0) * cos(0.9 * pose), sin(tilt / 2.0) * sin(0.9 * pose), 0.0 };
+        double truth[4];
+        double accel[3];
+        double mag[3];
+        Fusion_State_T state;
+        Fusion_Sample_T sample;
+
+        QuaternionMultiply(qYaw, qTilt, truth);
+        EarthToSensor(truth, gravity, accel);
+        EarthToSensor(truth, field, mag);
+        for (int i = 0; i < 3; i++)
+        {
+            sample.Accel[i] = Quantize(accel[i]);
+            sample.Gyro[i] = 0;
+            sample.Mag[i] = Quantize(mag[i] * FUSION_MAG_LSB);
+        }
+
+        /* Starting at the pose leaves only the error of the samples, not the convergence */
+        Fusion_Init(&state);
+        for (int i = 0; i < 4; i++)
+        {
+            state.Q[i] = (int32_t) lround(truth[i] * (double) (1L << FUSION_Q));
+        }
+        for (unsigned long n = 0; n < (unsigned long) (STATIC_SECONDS * FUSION_RATE); n++)
+        {
+            Fusion_Update(&state, &sample);
+        }
+        double fixedQ[4];
+        for (int i = 0; i < 4; i++)
+        {
+            fixedQ[i] = (double) state.Q[i] / (double) (1L << FUSION_Q);
+        }
+        maximum = fmax(maximum, AngleBetween(fixedQ, truth));
+    }
+    return (maximum);
+}
+
+static double ElapsedSeconds(const struct timespec * start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((double) (now.tv_sec - start->tv_sec) + 1e-9 * (double) (now.tv_nsec - start->tv_nsec));
+}
+
+int main(int argc, char ** argv)
+{
+    double seconds = DEFAULT_SECONDS;
+    unsigned long updates = DEFAULT_UPDATES;
+    double tolerance = DEFAULT_TOLERANCE;
+    int option;
+
+    while (-1 != (option = getopt(argc, argv, "s:n:t:")))
+    {
+        switch (option)
+        {
+        case 's':
+            seconds = strtod(optarg, NULL);
+            break;
+        case 'n':
+            updates = strtoul(optarg, NULL, 10);
+            break;
+        case 't':
+            tolerance = strtod(optarg, NULL);
+            break;
+        default:
+            fprintf(stderr, "usage: xdk_fusion [-s seconds] [-n updates] [-t tolerance_deg]\n");
+            return (EXIT_FAILURE);
+        }
+    }
+
+    /* The true orientation and both filters start at identity */
+    double truth[4] = { 1.0, 0.0, 0.0, 0.0 };
+    const double gravity[3] = { 0.0, 0.0, 1000.0 };
+    const double field[3] = { MAG_NORTH, 0.0, MAG_DOWN };
+    Fusion_State_T fixed;
+    Reference_T reference;
+    Fusion_Init(&fixed);
+    ReferenceInit(&reference);
+
+    unsigned long samples = (unsigned long) (seconds * FUSION_RATE);
+    double maximumFixedReference = 0.0;
+    double maximumOutputReference = 0.0;
+    double sumFixedReference = 0.0;
+    double maximumFixedTruth = 0.0;
+    double maximumReferenceTruth = 0.0;
+    double maximumLinear = 0.0;
+    unsigned long counted = 0;
+    Fusion_Sample_T sample;
+
+    for (unsigned long n = 0; n < samples; n++)
+    {
+        double time = (double) n / FUSION_RATE;
+        double rate[3];
+        double accel[3];
+        double mag[3];
+
+        MotionRate(time, rate);
+        for (int i = 0; i < 3; i++)
+        {
+            sample.Gyro[i] = Quantize(rate[i] * RAD_TO_DEG * 1000.0 + GYRO_BIAS);
+        }
+        for (int step = 0; step < SUBSTEPS; step++)
+        {
+            double substepRate[3];
+            double dt = 1.0 / (FUSION_RATE * SUBSTEPS);
+            MotionRate(time + step * dt, substepRate);
+            double delta[4] = { 1.0, 0.5 * substepRate[0] * dt, 0.5 * substepRate[1] * dt, 0.5 * substepRate[2] * dt };
+            double next[4];
+            QuaternionMultiply(truth, delta, next);
+            QuaternionNormalize(next);
+            for (int i = 0; i < 4; i++)
+            {
+                truth[i] = next[i];
+            }
+        }
+        EarthToSensor(truth, gravity, accel);
+        EarthToSensor(truth, field, mag);
+        for (int i = 0; i < 3; i++)
+        {
+            sample.Accel[i] = Quantize(accel[i]);
+            sample.Mag[i] = Quantize(mag[i] * FUSION_MAG_LSB);
+        }
+
+        Fusion_Update(&fixed, &sample);
+        ReferenceUpdate(&reference, &sample);
+
+        if (time < WARM_UP)
+        {
+            continue;
+        }
+        double fixedQ[4];
+        double outputQ[4];
+        int16_t output[4];
+        Fusion_GetQuaternion(&fixed, output);
+        for (int i = 0; i < 4; i++)
+        {
+            fixedQ[i] = (double) fixed.Q[i] / (double) (1L << FUSION_Q);
+            outputQ[i] = (double) output[i] / (double) (1L << FUSION_OUTPUT_Q);
+        }
+        QuaternionNormalize(outputQ);
+        double fixedReference = AngleBetween(fixedQ, reference.Q);
+        double outputReference = AngleBetween(outputQ, reference.Q);
+        double fixedTruth = AngleBetween(fixedQ, truth);
+        double referenceTruth = AngleBetween(reference.Q, truth);
+        maximumFixedReference = fmax(maximumFixedReference, fixedReference);
+        maximumOutputReference = fmax(maximumOutputReference, outputReference);
+        maximumFixedTruth = fmax(maximumFixedTruth, fixedTruth);
+        maximumReferenceTruth = fmax(maximumReferenceTruth, referenceTruth);
+        sumFixedReference += fixedReference * fixedReference;
+        counted++;
+
+        int32_t linear[3];
+        double referenceGravity[3];
+        Fusion_GetLinearAccel(&fixed, sample.Accel, linear);
+        EarthToSensor(reference.Q, gravity, referenceGravity);
+        for (int i = 0; i < 3; i++)
+        {
+            maximumLinear = fmax(maximumLinear, fabs((double) linear[i] - ((double) sample.Accel[i] - referenceGravity[i])));
+        }
+    }
+
+    printf("fixed vs reference:   max %.4f deg, rms %.4f deg\n", maximumFixedReference, sqrt(sumFixedReference / (double) ((0UL == counted) ? 1UL : counted)));
+    printf("Q%d output vs ref.:   max %.4f deg\n", FUSION_OUTPUT_Q, maximumOutputReference);
+    printf("fixed vs truth:       max %.4f deg\n", maximumFixedTruth);
+    printf("reference vs truth:   max %.4f deg\n", maximumReferenceTruth);
+    printf("linear accel vs ref.: max %.1f mG\n", maximumLinear);
+    printf("static vs truth:      max %.4f deg\n", StaticError());
+
+    /* Timing of the update alone, on samples of a slow rotation */
+    struct timespec start;
+    volatile int32_t sink = 0;
+    Fusion_Init(&fixed);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned long n = 0; n < updates; n++)
+    {
+        sample.Gyro[0] = (int32_t) (n & 0x3FFU);
+        Fusion_Update(&fixed, &sample);
+    }
+    sink = fixed.Q[0];
+    double fixedSeconds = ElapsedSeconds(&start);
+    ReferenceInit(&reference);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned long n = 0; n < updates; n++)
+    {
+        sample.Gyro[0] = (int32_t) (n & 0x3FFU);
+        ReferenceUpdate(&reference, &sample);
+    }
+    double referenceSeconds = ElapsedSeconds(&start);
+    (void) sink;
+    printf("host time per update: fixed %.1f ns, reference %.1f ns\n",
+            1e9 * fixedSeconds / (double) updates, 1e9 * referenceSeconds / (double) updates);
+
+    if (maximumFixedReference > tolerance)
+    {
+        fprintf(stderr, "xdk_fusion: fixed-point filter exceeds the %.2f deg tolerance\n", tolerance);
+        return (EXIT_FAILURE);
+    }
+    return (EXIT_SUCCESS);
+}
@@ -0,0 +1,155 @@
+/**
+ * @file
+ * @brief Host side parser for the datalogger session files, see XdkLog.h.
+ */
+#include "XdkLog.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ALL_CHANNELS                ((1U << XDKLOG_CHANNELS) - 1U)
+
+static const char * const ChannelNames[XDKLOG_CHANNELS] =
+{
+    "accel_x", "accel_y", "accel_z", "humidity", "pressure", "temperature", "light", "battery"
+};
+
+/**
+ * @brief Parses the next ';' separated number, advancing the cursor past the separator.
+ */
+static int ParseField(const char ** cursor, double * value)
+{
+    char * end = NULL;
+    *value = strtod(*cursor, &end);
+    if (end == *cursor)
+    {
+        return (0);
+    }
+    while ((' ' == *end) || ('\t' == *end))
+    {
+        end++;
+    }
+    if (';' == *end)
+    {
+        end++;
+    }
+    *cursor = end;
+    return (1);
+}
+
+/**
+ * @brief Parses the hexadecimal presence mask of a deadband record.
+ */
+static int ParseMask(const char ** cursor, uint32_t * mask)
+{
+    char * end = NULL;
+    unsigned long value = strtoul(*cursor, &end, 16);
+    if ((end == *cursor) || (value > ALL_CHANNELS))
+    {
+        return (0);
+    }
+    while ((' ' == *end) || ('\t' == *end))
+    {
+        end++;
+    }
+    if (';' == *end)
+    {
+        end++;
+    }
+    *cursor = end;
+    *mask = (uint32_t) value;
+    return (1);
+}
+
+const char * XdkLog_ChannelName(uint32_t channel)
+{
+    return ((channel < XDKLOG_CHANNELS) ? ChannelNames[channel] : "unknown");
+}
+
+void XdkLog_InitRecord(XdkLog_Record_T * record)
+{
+    record->Type = XDKLOG_RECORD_INVALID;
+    record->Time = 0;
+    record->Present = 0;
+    for (uint32_t i = 0; i < XDKLOG_CHANNELS; i++)
+    {
+        record->Value[i] = NAN;
+    }
+}
+
+XdkLog_RecordType_T XdkLog_ParseLine(const char * line, XdkLog_Record_T * record)
+{
+    const char * cursor = line;
+    double value = 0.0;
+
+    record->Type = XDKLOG_RECORD_INVALID;
+    while ((' ' == *cursor) || ('\t' == *cursor))
+    {
+        cursor++;
+    }
+
+    if (('T' == cursor[0] || 'Q' == cursor[0]) && ';' == cursor[1])
+    {
+        XdkLog_RecordType_T type = ('T' == cursor[0]) ? XDKLOG_RECORD_TELEMETRY : XDKLOG_RECORD_ORIENTATION;
+        cursor += 2;
+        if (ParseField(&cursor, &value))
+        {
+            record->Time = (uint32_t) value;
+            record->Type = type;
+        }
+        return (record->Type);
+    }
+
+    uint32_t present = ALL_CHANNELS;
+    int isDeadband = ('D' == cursor[0]) && (';' == cursor[1]);
+    if (isDeadband)
+    {
+        cursor += 2;
+    }
+    if (!ParseField(&cursor, &value))
+    {
+        return (record->Type);
+    }
+    if (isDeadband && !ParseMask(&cursor, &present))
+    {
+        return (record->Type);
+    }
+
+    /* Parse into a copy, a malformed line must not leave half updated held values */
+    double parsed[XDKLOG_CHANNELS];
+    for (uint32_t i = 0; i < XDKLOG_CHANNELS; i++)
+    {
+        parsed[i] = record->Value[i];
+        if ((0U != (present & (1U << i))) && !ParseField(&cursor, &parsed[i]))
+        {
+            return (record->Type);
+        }
+    }
+    memcpy(record->Value, parsed, sizeof(parsed));
+    record->Time = (uint32_t) value;
+    record->Present = present;
+    record->Type = XDKLOG_RECORD_SAMPLE;
+    return (record->Type);
+}
+
+int XdkLog_ReadSample(FILE * file, XdkLog_Record_T * record)
+{
+    char line[XDKLOG_LINE_SIZE];
+
+    while (NULL != fgets(line, sizeof(line), file))
+    {
+        if (XDKLOG_RECORD_SAMPLE == XdkLog_ParseLine(line, record))
+        {
+            return (1);
+        }
+    }
+    return (0);
+}
+
+int XdkLog_FormatSample(const XdkLog_Record_T * record, char * buffer, size_t size)
+{
+    const double * value = record->Value;
+    return (snprintf(buffer, size, "%3lu; %3.0f; %3.0f; %3.0f; %3.0f; %3.0f; %.3f; %.3f; %.3f",
+            (unsigned long) record->Time, value[0], value[1], value[2], value[3], value[4], value[5], value[6], value[7]));
+}
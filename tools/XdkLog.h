@@ -0,0 +1,80 @@
+/**
+ * @file
+ * @brief Host side parser for the datalogger session files (data_##.csv).
+ *
+ * @details Every line of a session file is one record. Sensor rows carry the session time in
+ * milliseconds (cycle * WRITEREAD_DELAY) followed by the channel values; lines starting with
+ * "T;" are telemetry records and lines starting with "Q;" orientation records interleaved by
+ * the logger.
+ *
+ * With the deadband filter of the logger, sensor rows are "D; <ms>; <mask>; <values>" records
+ * which only hold the channels set in the hexadecimal presence mask. The other channels keep the
+ * value of the previous record, so the same record has to be passed for all lines of a file.
+ */
+#ifndef XDKLOG_H_
+#define XDKLOG_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define XDKLOG_CHANNELS             8U      /**< Number of value channels in a sensor row */
+#define XDKLOG_LINE_SIZE            1024U   /**< Longest record line accepted */
+
+/** Type of a parsed session file line */
+typedef enum
+{
+    XDKLOG_RECORD_INVALID = 0,  /**< Empty or malformed line */
+    XDKLOG_RECORD_SAMPLE,       /**< Sensor row, Time and Value are valid */
+    XDKLOG_RECORD_TELEMETRY,    /**< Telemetry row, only Time is valid */
+    XDKLOG_RECORD_ORIENTATION,  /**< Orientation row, only Time is valid */
+} XdkLog_RecordType_T;
+
+/** One parsed session file line */
+typedef struct
+{
+    XdkLog_RecordType_T Type;
+    uint32_t Time;                      /**< Session time in milliseconds */
+    uint32_t Present;                   /**< Mask of the channels stored in this line, the others are held */
+    double Value[XDKLOG_CHANNELS];      /**< Channel values in the units written by the logger */
+} XdkLog_Record_T;
+
+/**
+ * @brief Returns the short name of a value channel, e.g. "accel_x".
+ */
+const char * XdkLog_ChannelName(uint32_t channel);
+
+/**
+ * @brief Prepares a record for the first line of a session file, all channels unknown (NaN).
+ */
+void XdkLog_InitRecord(XdkLog_Record_T * record);
+
+/**
+ * @brief Parses one line of a session file.
+ *
+ * @param[in] line Zero terminated line, the trailing newline is optional
+ *
+ * @param[in,out] record Parsed record, channels missing in a deadband record keep their value
+ *
+ * @return Type of the record, also stored in record->Type
+ */
+XdkLog_RecordType_T XdkLog_ParseLine(const char * line, XdkLog_Record_T * record);
+
+/**
+ * @brief Reads the next sample record of a session file, skipping telemetry, orientation and malformed lines.
+ *
+ * @param[in] file Session file opened for reading
+ *
+ * @param[in,out] record Parsed sample record, see XdkLog_ParseLine()
+ *
+ * @return 1 if a sample was read, 0 at the end of the file
+ */
+int XdkLog_ReadSample(FILE * file, XdkLog_Record_T * record);
+
+/**
+ * @brief Formats a sample record as a complete row "<ms>; <accel_x>; ...; <battery>" without newline.
+ *
+ * @return Number of characters written, as snprintf()
+ */
+int XdkLog_FormatSample(const XdkLog_Record_T * record, char * buffer, size_t size);
+
+#endif /* XDKLOG_H_ */
@@ -0,0 +1,664 @@
+/**
+ * @file
+ * @brief Largest-Triangle-Three-Buckets downsampler for datalogger session files.
+ *
+ * @details The session file is streamed once. Only two buckets per channel and pyramid level are
+ * buffered, so memory depends on the bucket size and not on the session length. The bucket size is
+ * derived from the file size and the average length of lines sampled across the file, or given with -n.
+ *
+ * Parsing runs on the main thread into one of two row blocks while the worker threads downsample
+ * the other block, each worker owning a fixed subset of the channels.
+ *
+ * Usage:
+ *   xdk_lttb [-t points] [-L levels] [-j threads] [-n rows] [-p cache] data_##.csv
+ *       Prints "channel; ms; value" for the coarsest level, optionally writing a pyramid cache
+ *       with levels of points, 4 * points, 16 * points, ...
+ *   xdk_lttb -c cache [-l level]
+ *       Prints one level of a previously written pyramid cache.
+ */
+#include "XdkLog.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define DEFAULT_TARGET_POINTS       1000U
+#define DEFAULT_LEVELS              1U
+#define MAX_LEVELS                  8U
+#define LEVEL_FACTOR_SHIFT          2U      /**< Each pyramid level has 4 times the points of the previous one */
+#define BLOCK_ROWS                  8192U   /**< Rows handed to the workers at once */
+#define ESTIMATE_LINES              128U    /**< Lines sampled per part of the file to estimate the row count */
+#define ESTIMATE_PARTS              4U      /**< Evenly spaced file positions sampled for the estimate */
+#define CACHE_MAGIC                 "XDKLTTB1"
+#define CACHE_MAGIC_SIZE            8U
+
+/** Downsampled point of one channel */
+typedef struct
+{
+    uint32_t Time;
+    float Value;
+} Point_T;
+
+/** Growable list of selected points */
+typedef struct
+{
+    Point_T * Items;
+    size_t Count;
+    size_t Capacity;
+} PointList_T;
+
+/** Streaming LTTB state of one channel at one pyramid level */
+typedef struct
+{
+    uint32_t BucketRows;
+    uint32_t * CurrentTime;
+    double * CurrentValue;
+    uint32_t CurrentCount;
+    uint32_t * NextTime;
+    double * NextValue;
+    uint32_t NextCount;
+    uint32_t AnchorTime;
+    double AnchorValue;
+    uint32_t LastTime;
+    double LastValue;
+    uint64_t Seen;
+    PointList_T Selected;
+} Lttb_T;
+
+/** Shared state between the parser and the worker threads */
+typedef struct
+{
+    uint32_t Time[2][BLOCK_ROWS];
+    double Value[2][XDKLOG_CHANNELS][BLOCK_ROWS];
+    uint32_t Rows[2];
+    XdkLog_Record_T Record;     /**< Parser state, holds the channels missing in deadband records */
+    uint32_t Active;
+    int Stop;
+    uint32_t Threads;
+    uint32_t Levels;
+    Lttb_T Lttb[XDKLOG_CHANNELS][MAX_LEVELS];
+    pthread_barrier_t Start;
+    pthread_barrier_t Done;
+} Context_T;
+
+typedef struct
+{
+    Context_T * Context;
+    uint32_t Id;
+} Worker_T;
+
+static void * CheckedAlloc(size_t size)
+{
+    void * memory = malloc(size);
+    if (NULL == memory)
+    {
+        fprintf(stderr, "xdk_lttb: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    return (memory);
+}
+
+static void PointListAppend(PointList_T * list, uint32_t time, double value)
+{
+    if (list->Count == list->Capacity)
+    {
+        list->Capacity = (0U == list->Capacity) ? 256U : (list->Capacity * 2U);
+        list->Items = realloc(list->Items, list->Capacity * sizeof(Point_T));
+        if (NULL == list->Items)
+        {
+            fprintf(stderr, "xdk_lttb: out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    list->Items[list->Count].Time = time;
+    list->Items[list->Count].Value = (float) value;
+    list->Count++;
+}
+
+static void LttbInit(Lttb_T * lttb, uint32_t bucketRows)
+{
+    memset(lttb, 0, sizeof(*lttb));
+    lttb->BucketRows = bucketRows;
+    lttb->CurrentTime = CheckedAlloc(bucketRows * sizeof(uint32_t));
+    lttb->CurrentValue = CheckedAlloc(bucketRows * sizeof(double));
+    lttb->NextTime = CheckedAlloc(bucketRows * sizeof(uint32_t));
+    lttb->NextValue = CheckedAlloc(bucketRows * sizeof(double));
+}
+
+/**
+ * @brief Selects the point of the current bucket forming the largest triangle with the anchor
+ * (previously selected point) and the given third vertex, and makes it the new anchor.
+ */
+static void LttbSelect(Lttb_T * lttb, double thirdTime, double thirdValue)
+{
+    double anchorTime = (double) lttb->AnchorTime;
+    double bestArea = -1.0;
+    uint32_t best = 0;
+
+    for (uint32_t i = 0; i < lttb->CurrentCount; i++)
+    {
+        double area = (anchorTime - thirdTime) * (lttb->CurrentValue[i] - lttb->AnchorValue)
+                - (anchorTime - (double) lttb->CurrentTime[i]) * (thirdValue - lttb->AnchorValue);
+        if (area < 0.0)
+        {
+            area = -area;
+        }
+        if (area > bestArea)
+        {
+            bestArea = area;
+            best = i;
+        }
+    }
+    lttb->AnchorTime = lttb->CurrentTime[best];
+    lttb->AnchorValue = lttb->CurrentValue[best];
+    PointListAppend(&lttb->Selected, lttb->AnchorTime, lttb->AnchorValue);
+}
+
+static void LttbSwapBuckets(Lttb_T * lttb)
+{
+    uint32_t * time = lttb->CurrentTime;
+    double * value = lttb->CurrentValue;
+    lttb->CurrentTime = lttb->NextTime;
+    lttb->CurrentValue = lttb->NextValue;
+    lttb->CurrentCount = lttb->NextCount;
+    lttb->NextTime = time;
+    lttb->NextValue = value;
+    lttb->NextCount = 0;
+}
+
+static void BucketAverage(const uint32_t * time, const double * value, uint32_t count, double * averageTime, double * averageValue)
+{
+    double sumTime = 0.0;
+    double sumValue = 0.0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        sumTime += (double) time[i];
+        sumValue += value[i];
+    }
+    *averageTime = sumTime / (double) count;
+    *averageValue = sumValue / (double) count;
+}
+
+static void LttbPush(Lttb_T * lttb, uint32_t time, double value)
+{
+    if (0U == lttb->Seen++)
+    {
+        /* The first point is always kept */
+        lttb->AnchorTime = time;
+        lttb->AnchorValue = value;
+        PointListAppend(&lttb->Selected, time, value);
+        return;
+    }
+    lttb->LastTime = time;
+    lttb->LastValue = value;
+
+    if (lttb->CurrentCount < lttb->BucketRows)
+    {
+        lttb->CurrentTime[lttb->CurrentCount] = time;
+        lttb->CurrentValue[lttb->CurrentCount++] = value;
+        return;
+    }
+    lttb->NextTime[lttb->NextCount] = time;
+    lttb->NextValue[lttb->NextCount++] = value;
+    if (lttb->NextCount == lttb->BucketRows)
+    {
+        double averageTime;
+        double averageValue;
+        BucketAverage(lttb->NextTime, lttb->NextValue, lttb->NextCount, &averageTime, &averageValue);
+        LttbSelect(lttb, averageTime, averageValue);
+        LttbSwapBuckets(lttb);
+    }
+}
+
+static void LttbFinish(Lttb_T * lttb)
+{
+    if (lttb->Seen < 2U)
+    {
+        return;
+    }
+    /* The last point is always kept, take it out of its bucket */
+    if (lttb->NextCount > 0U)
+    {
+        lttb->NextCount--;
+    }
+    else
+    {
+        lttb->CurrentCount--;
+    }
+
+    if (lttb->CurrentCount > 0U)
+    {
+        double averageTime = (double) lttb->LastTime;
+        double averageValue = lttb->LastValue;
+        if (lttb->NextCount > 0U)
+        {
+            BucketAverage(lttb->NextTime, lttb->NextValue, lttb->NextCount, &averageTime, &averageValue);
+        }
+        LttbSelect(lttb, averageTime, averageValue);
+    }
+    if (lttb->NextCount > 0U)
+    {
+        LttbSwapBuckets(lttb);
+        LttbSelect(lttb, (double) lttb->LastTime, lttb->LastValue);
+    }
+    PointListAppend(&lttb->Selected, lttb->LastTime, lttb->LastValue);
+}
+
+static void * WorkerRun(void * argument)
+{
+    Worker_T * worker = argument;
+    Context_T * context = worker->Context;
+
+    for (;;)
+    {
+        pthread_barrier_wait(&context->Start);
+        if (context->Stop)
+        {
+            break;
+        }
+        uint32_t block = context->Active;
+        for (uint32_t channel = worker->Id; channel < XDKLOG_CHANNELS; channel += context->Threads)
+        {
+            for (uint32_t level = 0; level < context->Levels; level++)
+            {
+                Lttb_T * lttb = &context->Lttb[channel][level];
+                for (uint32_t row = 0; row < context->Rows[block]; row++)
+                {
+                    LttbPush(lttb, context->Time[block][row], context->Value[block][channel][row]);
+                }
+            }
+        }
+        pthread_barrier_wait(&context->Done);
+    }
+    return (NULL);
+}
+
+static uint32_t FillBlock(Context_T * context, uint32_t block, FILE * file)
+{
+    XdkLog_Record_T * record = &context->Record;
+    uint32_t rows = 0;
+
+    while ((rows < BLOCK_ROWS) && XdkLog_ReadSample(file, record))
+    {
+        context->Time[block][rows] = record->Time;
+        for (uint32_t channel = 0; channel < XDKLOG_CHANNELS; channel++)
+        {
+            context->Value[block][channel][rows] = record->Value[channel];
+        }
+        rows++;
+    }
+    return (rows);
+}
+
+/**
+ * @brief Estimates the number of sample rows from the file size and lines sampled at the start,
+ * the middle and the end of the file, since the timestamp column widens along the session.
+ */
+static uint64_t EstimateRows(FILE * file)
+{
+    struct stat status;
+    char line[XDKLOG_LINE_SIZE];
+    XdkLog_Record_T record;
+    uint64_t bytes = 0;
+    uint32_t samples = 0;
+
+    XdkLog_InitRecord(&record);
+    if ((0 != fstat(fileno(file), &status)) || !S_ISREG(status.st_mode))
+    {
+        return (0);
+    }
+    for (uint32_t part = 0; part < ESTIMATE_PARTS; part++)
+    {
+        long position = (long) (((uint64_t) status.st_size * part) / ESTIMATE_PARTS);
+        if ((0 != fseek(file, position, SEEK_SET)) || ((position > 0) && (NULL == fgets(line, sizeof(line), file))))
+        {
+            /* Skip the partial line at a mid file position */
+            break;
+        }
+        for (uint32_t lines = 0; (lines < ESTIMATE_LINES) && (NULL != fgets(line, sizeof(line), file)); lines++)
+        {
+            bytes += strlen(line);
+            if (XDKLOG_RECORD_SAMPLE == XdkLog_ParseLine(line, &record))
+            {
+                samples++;
+            }
+        }
+    }
+    rewind(file);
+    if (0U == bytes)
+    {
+        return (0);
+    }
+    return (((uint64_t) status.st_size * samples) / bytes);
+}
+
+static void PutU32(FILE * file, uint32_t value)
+{
+    uint8_t bytes[4] = { (uint8_t) value, (uint8_t) (value >> 8), (uint8_t) (value >> 16), (uint8_t) (value >> 24) };
+    fwrite(bytes, 1, sizeof(bytes), file);
+}
+
+static void PutU64(FILE * file, uint64_t value)
+{
+    PutU32(file, (uint32_t) value);
+    PutU32(file, (uint32_t) (value >> 32));
+}
+
+static int GetU32(FILE * file, uint32_t * value)
+{
+    uint8_t bytes[4];
+    if (sizeof(bytes) != fread(bytes, 1, sizeof(bytes), file))
+    {
+        return (0);
+    }
+    *value = (uint32_t) bytes[0] | ((uint32_t) bytes[1] << 8) | ((uint32_t) bytes[2] << 16) | ((uint32_t) bytes[3] << 24);
+    return (1);
+}
+
+static int GetU64(FILE * file, uint64_t * value)
+{
+    uint32_t low;
+    uint32_t high;
+    if (!GetU32(file, &low) || !GetU32(file, &high))
+    {
+        return (0);
+    }
+    *value = (uint64_t) low | ((uint64_t) high << 32);
+    return (1);
+}
+
+/**
+ * @brief Writes the pyramid cache.
+ *
+ * Layout (little endian): magic, u32 channels, u32 levels, u64 source rows, then per level and
+ * channel a directory entry {u32 bucket rows, u32 point count, u64 payload offset}, then the
+ * payload of {u32 ms, f32 value} points.
+ */
+static int WriteCache(const char * path, Context_T * context, uint64_t sourceRows)
+{
+    FILE * file = fopen(path, "wb");
+    if (NULL == file)
+    {
+        fprintf(stderr, "xdk_lttb: cannot create %s: %s\n", path, strerror(errno));
+        return (0);
+    }
+
+    uint64_t offset = CACHE_MAGIC_SIZE + 16U + ((uint64_t) context->Levels * XDKLOG_CHANNELS * 16U);
+    fwrite(CACHE_MAGIC, 1, CACHE_MAGIC_SIZE, file);
+    PutU32(file, XDKLOG_CHANNELS);
+    PutU32(file, context->Levels);
+    PutU64(file, sourceRows);
+    for (uint32_t level = 0; level < context->Levels; level++)
+    {
+        for (uint32_t channel = 0; channel < XDKLOG_CHANNELS; channel++)
+        {
+            const Lttb_T * lttb = &context->Lttb[channel][level];
+            PutU32(file, lttb->BucketRows);
+            PutU32(file, (uint32_t) lttb->Selected.Count);
+            PutU64(file, offset);
+            offset += lttb->Selected.Count * 8U;
+        }
+    }
+    for (uint32_t level = 0; level < context->Levels; level++)
+    {
+        for (uint32_t channel = 0; channel < XDKLOG_CHANNELS; channel++)
+        {
+            const PointList_T * list = &context->Lttb[channel][level].Selected;
+            for (size_t i = 0; i < list->Count; i++)
+            {
+                uint32_t bits;
+                memcpy(&bits, &list->Items[i].Value, sizeof(bits));
+                PutU32(file, list->Items[i].Time);
+                PutU32(file, bits);
+            }
+        }
+    }
+
+    int ok = !ferror(file);
+    if (0 != fclose(file))
+    {
+        ok = 0;
+    }
+    if (!ok)
+    {
+        fprintf(stderr, "xdk_lttb: write error on %s\n", path);
+    }
+    return (ok);
+}
+
+/**
+ * @brief Prints one level of a pyramid cache, seeking straight to its points.
+ */
+static int PrintCacheLevel(const char * path, uint32_t level)
+{
+    char magic[CACHE_MAGIC_SIZE];
+    uint32_t channels;
+    uint32_t levels;
+    uint64_t sourceRows;
+    FILE * file = fopen(path, "rb");
+
+    if (NULL == file)
+    {
+        fprintf(stderr, "xdk_lttb: cannot open %s: %s\n", path, strerror(errno));
+        return (0);
+    }
+    if ((CACHE_MAGIC_SIZE != fread(magic, 1, CACHE_MAGIC_SIZE, file)) || (0 != memcmp(magic, CACHE_MAGIC, CACHE_MAGIC_SIZE))
+            || !GetU32(file, &channels) || !GetU32(file, &levels) || !GetU64(file, &sourceRows) || (channels > XDKLOG_CHANNELS))
+    {
+        fprintf(stderr, "xdk_lttb: %s is not a pyramid cache\n", path);
+        fclose(file);
+        return (0);
+    }
+    if (level >= levels)
+    {
+        fprintf(stderr, "xdk_lttb: %s has %u levels\n", path, levels);
+        fclose(file);
+        return (0);
+    }
+
+    uint32_t count[XDKLOG_CHANNELS];
+    uint64_t offset[XDKLOG_CHANNELS];
+    uint32_t bucketRows;
+    if (0 != fseek(file, (long) (CACHE_MAGIC_SIZE + 16U + ((uint64_t) level * channels * 16U)), SEEK_SET))
+    {
+        fclose(file);
+        return (0);
+    }
+    for (uint32_t channel = 0; channel < channels; channel++)
+    {
+        if (!GetU32(file, &bucketRows) || !GetU32(file, &count[channel]) || !GetU64(file, &offset[channel]))
+        {
+            fprintf(stderr, "xdk_lttb: truncated directory in %s\n", path);
+            fclose(file);
+            return (0);
+        }
+    }
+    for (uint32_t channel = 0; channel < channels; channel++)
+    {
+        if (0 != fseek(file, (long) offset[channel], SEEK_SET))
+        {
+            fclose(file);
+            return (0);
+        }
+        for (uint32_t i = 0; i < count[channel]; i++)
+        {
+            uint32_t time;
+            uint32_t bits;
+            float value;
+            if (!GetU32(file, &time) || !GetU32(file, &bits))
+            {
+                fprintf(stderr, "xdk_lttb: truncated payload in %s\n", path);
+                fclose(file);
+                return (0);
+            }
+            memcpy(&value, &bits, sizeof(value));
+            printf("%s; %u; %.3f\n", XdkLog_ChannelName(channel), time, value);
+        }
+    }
+    fclose(file);
+    return (1);
+}
+
+static void Usage(void)
+{
+    fprintf(stderr,
+            "usage: xdk_lttb [-t points] [-L levels] [-j threads] [-n rows] [-p cache] data_##.csv\n"
+            "       xdk_lttb -c cache [-l level]\n");
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char ** argv)
+{
+    uint32_t target = DEFAULT_TARGET_POINTS;
+    uint32_t levels = DEFAULT_LEVELS;
+    uint32_t threads = XDKLOG_CHANNELS;
+    uint32_t level = 0;
+    uint64_t rows = 0;
+    const char * cachePath = NULL;
+    const char * readCachePath = NULL;
+    int option;
+
+    while (-1 != (option = getopt(argc, argv, "t:L:j:n:p:c:l:")))
+    {
+        switch (option)
+        {
+        case 't':
+            target = (uint32_t) strtoul(optarg, NULL, 10);
+            break;
+        case 'L':
+            levels = (uint32_t) strtoul(optarg, NULL, 10);
+            break;
+        case 'j':
+            threads = (uint32_t) strtoul(optarg, NULL, 10);
+            break;
+        case 'n':
+            rows = strtoull(optarg, NULL, 10);
+            break;
+        case 'p':
+            cachePath = optarg;
+            break;
+        case 'c':
+            readCachePath = optarg;
+            break;
+        case 'l':
+            level = (uint32_t) strtoul(optarg, NULL, 10);
+            break;
+        default:
+            Usage();
+        }
+    }
+
+    if (NULL != readCachePath)
+    {
+        return (PrintCacheLevel(readCachePath, level) ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+    if ((optind + 1 != argc) || (target < 3U) || (0U == levels) || (levels > MAX_LEVELS) || (0U == threads))
+    {
+        Usage();
+    }
+    if (threads > XDKLOG_CHANNELS)
+    {
+        threads = XDKLOG_CHANNELS;
+    }
+
+    FILE * file = (0 == strcmp(argv[optind], "-")) ? stdin : fopen(argv[optind], "r");
+    if (NULL == file)
+    {
+        fprintf(stderr, "xdk_lttb: cannot open %s: %s\n", argv[optind], strerror(errno));
+        return (EXIT_FAILURE);
+    }
+    if (0U == rows)
+    {
+        rows = EstimateRows(file);
+    }
+    if (0U == rows)
+    {
+        fprintf(stderr, "xdk_lttb: cannot size the buckets of a stream, pass -n rows\n");
+        return (EXIT_FAILURE);
+    }
+
+    /* The first and last points are kept apart from the buckets */
+    uint64_t bucketRows = (rows > 2U) ? ((rows - 2U + (target - 2U) - 1U) / (target - 2U)) : 1U;
+    Context_T * context = CheckedAlloc(sizeof(Context_T));
+    memset(context, 0, sizeof(*context));
+    context->Threads = threads;
+    XdkLog_InitRecord(&context->Record);
+    for (context->Levels = 0; context->Levels < levels; context->Levels++)
+    {
+        uint64_t levelRows = bucketRows >> (LEVEL_FACTOR_SHIFT * context->Levels);
+        if ((context->Levels > 0U) && (levelRows < 2U))
+        {
+            /* Finer levels would hold every sample, the session file itself serves them */
+            break;
+        }
+        for (uint32_t channel = 0; channel < XDKLOG_CHANNELS; channel++)
+        {
+            LttbInit(&context->Lttb[channel][context->Levels], (levelRows > 0U) ? (uint32_t) levelRows : 1U);
+        }
+    }
+
+    pthread_t thread[XDKLOG_CHANNELS];
+    Worker_T worker[XDKLOG_CHANNELS];
+    pthread_barrier_init(&context->Start, NULL, threads + 1U);
+    pthread_barrier_init(&context->Done, NULL, threads + 1U);
+    for (uint32_t i = 0; i < threads; i++)
+    {
+        worker[i].Context = context;
+        worker[i].Id = i;
+        if (0 != pthread_create(&thread[i], NULL, WorkerRun, &worker[i]))
+        {
+            fprintf(stderr, "xdk_lttb: cannot start worker threads\n");
+            return (EXIT_FAILURE);
+        }
+    }
+
+    uint64_t sourceRows = 0;
+    uint32_t block = 0;
+    context->Rows[block] = FillBlock(context, block, file);
+    while (context->Rows[block] > 0U)
+    {
+        sourceRows += context->Rows[block];
+        context->Active = block;
+        pthread_barrier_wait(&context->Start);
+        context->Rows[block ^ 1U] = FillBlock(context, block ^ 1U, file);
+        pthread_barrier_wait(&context->Done);
+        block ^= 1U;
+    }
+    context->Stop = 1;
+    pthread_barrier_wait(&context->Start);
+    for (uint32_t i = 0; i < threads; i++)
+    {
+        pthread_join(thread[i], NULL);
+    }
+    if (stdin != file)
+    {
+        fclose(file);
+    }
+
+    for (uint32_t l = 0; l < context->Levels; l++)
+    {
+        for (uint32_t channel = 0; channel < XDKLOG_CHANNELS; channel++)
+        {
+            LttbFinish(&context->Lttb[channel][l]);
+        }
+    }
+    for (uint32_t channel = 0; channel < XDKLOG_CHANNELS; channel++)
+    {
+        const PointList_T * list = &context->Lttb[channel][0].Selected;
+        for (size_t i = 0; i < list->Count; i++)
+        {
+            printf("%s; %u; %.3f\n", XdkLog_ChannelName(channel), list->Items[i].Time, list->Items[i].Value);
+        }
+    }
+    fprintf(stderr, "xdk_lttb: %llu rows, %u levels, %llu rows per coarsest bucket\n",
+            (unsigned long long) sourceRows, context->Levels, (unsigned long long) bucketRows);
+
+    if ((NULL != cachePath) && !WriteCache(cachePath, context, sourceRows))
+    {
+        return (EXIT_FAILURE);
+    }
+    return (EXIT_SUCCESS);
+}
@@ -0,0 +1,409 @@
+/**
+ * @file
+ * @brief Time aligned k-way merge of session files from many devices.
+ *
+ * @details Session files only carry the device local time cycle * WRITEREAD_DELAY. The anchors
+ * file ties local session times to wall clock times, one anchor per line:
+ *
+ *   <device>; <session file>; <session ms>; <wall clock ms>
+ *
+ * Every session needs at least one anchor. The clock drift of a device is the pooled slope of
+ * wall against session time over all sessions of the device with two or more anchors, and the
+ * offset of a session is fitted on its own anchors with that slope. Anchors with non-numeric times
+ * and devices whose fitted wall time does not grow with session time are rejected.
+ *
+ * The merge streams the sessions through a binary heap keyed by wall clock time. A session is
+ * only opened once the merge reaches its start and is closed at its end, so memory and open files
+ * depend on how many sessions overlap in time, not on how many are merged.
+ *
+ * Output lines are "<wall ms>; <device>; <record>", where sensor records are complete rows with the
+ * channels missing in deadband records held from the previous record of the session, and other
+ * records are copied unchanged.
+ *
+ * Usage:
+ *   xdk_merge anchors.txt > merged.csv
+ */
+#include "XdkLog.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NAME_SIZE                   32U
+#define PATH_SIZE                   512U
+#define FIELD_COUNT                 4U
+#define READ_BUFFER_SIZE            (64U * 1024U)   /**< stdio buffer per open session file */
+
+/** Clock model of one device */
+typedef struct
+{
+    char Name[NAME_SIZE];
+    double SumXX;       /**< Within-session sum of squared session time deviations */
+    double SumXY;       /**< Within-session sum of session and wall time deviation products */
+    double Slope;       /**< Wall clock ms per session ms, 1 + drift */
+} Device_T;
+
+typedef enum
+{
+    SESSION_PENDING = 0,    /**< Not opened yet, keyed by its earliest possible time */
+    SESSION_OPEN,           /**< Keyed by the wall time of the record in Line */
+} SessionState_T;
+
+/** One session file with its anchors and merge state */
+typedef struct
+{
+    char Path[PATH_SIZE];
+    uint32_t Device;
+    uint32_t Anchors;
+    double ReferenceLocal;  /**< First anchor, anchors are accumulated relative to it for precision */
+    int64_t ReferenceWall;
+    double SumX;
+    double SumY;
+    double SumXX;
+    double SumXY;
+    double Offset;          /**< Wall time at session time zero, relative to ReferenceWall */
+    SessionState_T State;
+    FILE * File;
+    char * Buffer;
+    char Line[XDKLOG_LINE_SIZE];
+    XdkLog_Record_T Record;
+    int64_t Key;
+} Session_T;
+
+static Device_T * Devices = NULL;
+static uint32_t DeviceCount = 0;
+static Session_T * Sessions = NULL;
+static uint32_t SessionCount = 0;
+static uint32_t * Heap = NULL;
+static uint32_t HeapSize = 0;
+
+static void * CheckedRealloc(void * memory, size_t size)
+{
+    memory = realloc(memory, size);
+    if (NULL == memory)
+    {
+        fprintf(stderr, "xdk_merge: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    return (memory);
+}
+
+static char * Trim(char * text)
+{
+    while ((' ' == *text) || ('\t' == *text))
+    {
+        text++;
+    }
+    char * end = text + strlen(text);
+    while ((end > text) && ((' ' == end[-1]) || ('\t' == end[-1]) || ('\r' == end[-1]) || ('\n' == end[-1])))
+    {
+        *--end = '\0';
+    }
+    return (text);
+}
+
+static uint32_t FindDevice(const char * name)
+{
+    for (uint32_t i = 0; i < DeviceCount; i++)
+    {
+        if (0 == strcmp(Devices[i].Name, name))
+        {
+            return (i);
+        }
+    }
+    Devices = CheckedRealloc(Devices, (DeviceCount + 1U) * sizeof(Device_T));
+    memset(&Devices[DeviceCount], 0, sizeof(Device_T));
+    snprintf(Devices[DeviceCount].Name, NAME_SIZE, "%s", name);
+    return (DeviceCount++);
+}
+
+static uint32_t FindSession(uint32_t device, const char * path)
+{
+    for (uint32_t i = 0; i < SessionCount; i++)
+    {
+        if ((Sessions[i].Device == device) && (0 == strcmp(Sessions[i].Path, path)))
+        {
+            return (i);
+        }
+    }
+    Sessions = CheckedRealloc(Sessions, (SessionCount + 1U) * sizeof(Session_T));
+    memset(&Sessions[SessionCount], 0, sizeof(Session_T));
+    snprintf(Sessions[SessionCount].Path, PATH_SIZE, "%s", path);
+    Sessions[SessionCount].Device = device;
+    return (SessionCount++);
+}
+
+static int ReadAnchors(const char * path)
+{
+    char line[PATH_SIZE + 128U];
+    uint32_t lineNumber = 0;
+    FILE * file = fopen(path, "r");
+
+    if (NULL == file)
+    {
+        fprintf(stderr, "xdk_merge: cannot open %s: %s\n", path, strerror(errno));
+        return (0);
+    }
+    while (NULL != fgets(line, sizeof(line), file))
+    {
+        char * field[FIELD_COUNT];
+        char * cursor = line;
+        uint32_t fields = 0;
+
+        lineNumber++;
+        if (('#' == *Trim(line)) || ('\0' == *Trim(line)))
+        {
+            continue;
+        }
+        while ((fields < FIELD_COUNT) && (NULL != cursor))
+        {
+            char * separator = strchr(cursor, ';');
+            if (NULL != separator)
+            {
+                *separator = '\0';
+            }
+            field[fields++] = Trim(cursor);
+            cursor = (NULL != separator) ? (separator + 1) : NULL;
+        }
+        char * localEnd = NULL;
+        char * wallEnd = NULL;
+        double local = (FIELD_COUNT == fields) ? strtod(field[2], &localEnd) : 0.0;
+        int64_t wall = (FIELD_COUNT == fields) ? strtoll(field[3], &wallEnd, 10) : 0;
+        if ((FIELD_COUNT != fields) || ('\0' == field[0][0]) || ('\0' == field[1][0])
+                || (localEnd == field[2]) || ('\0' != *localEnd) || (wallEnd == field[3]) || ('\0' != *wallEnd))
+        {
+            fprintf(stderr, "xdk_merge: %s:%u: expected <device>; <file>; <session ms>; <wall ms>\n", path, lineNumber);
+            fclose(file);
+            return (0);
+        }
+
+        uint32_t index = FindSession(FindDevice(field[0]), field[1]);
+        Session_T * session = &Sessions[index];
+        if (0U == session->Anchors)
+        {
+            session->ReferenceLocal = local;
+            session->ReferenceWall = wall;
+        }
+        double x = local - session->ReferenceLocal;
+        double y = (double) (wall - session->ReferenceWall);
+        session->Anchors++;
+        session->SumX += x;
+        session->SumY += y;
+        session->SumXX += x * x;
+        session->SumXY += x * y;
+    }
+    fclose(file);
+    return (1);
+}
+
+/**
+ * @brief Fits the drift of every device and the offset of every session.
+ *
+ * @return 0 if a device clock runs backwards, the merge keys need wall time to grow with session time
+ */
+static int FitClocks(void)
+{
+    for (uint32_t i = 0; i < SessionCount; i++)
+    {
+        Session_T * session = &Sessions[i];
+        double n = (double) session->Anchors;
+        Devices[session->Device].SumXX += session->SumXX - ((session->SumX * session->SumX) / n);
+        Devices[session->Device].SumXY += session->SumXY - ((session->SumX * session->SumY) / n);
+    }
+    for (uint32_t i = 0; i < DeviceCount; i++)
+    {
+        Device_T * device = &Devices[i];
+        /* Without a session spanning two anchors the drift is unknown, assume a nominal clock */
+        device->Slope = (device->SumXX > 0.0) ? (device->SumXY / device->SumXX) : 1.0;
+        if (!(device->Slope > 0.0))
+        {
+            fprintf(stderr, "xdk_merge: %s: wall time does not grow with session time, check the anchors\n", device->Name);
+            return (0);
+        }
+    }
+    for (uint32_t i = 0; i < SessionCount; i++)
+    {
+        Session_T * session = &Sessions[i];
+        double n = (double) session->Anchors;
+        double slope = Devices[session->Device].Slope;
+        session->Offset = (session->SumY / n) - (slope * ((session->SumX / n) + session->ReferenceLocal));
+    }
+    return (1);
+}
+
+static int64_t WallTime(const Session_T * session, uint32_t local)
+{
+    double relative = session->Offset + (Devices[session->Device].Slope * (double) local);
+    return (session->ReferenceWall + (int64_t) ((relative < 0.0) ? (relative - 0.5) : (relative + 0.5)));
+}
+
+static int HeapLess(uint32_t a, uint32_t b)
+{
+    if (Sessions[a].Key != Sessions[b].Key)
+    {
+        return (Sessions[a].Key < Sessions[b].Key);
+    }
+    return (a < b);
+}
+
+static void HeapSiftDown(uint32_t position)
+{
+    for (;;)
+    {
+        uint32_t smallest = position;
+        uint32_t left = (2U * position) + 1U;
+        uint32_t right = left + 1U;
+        if ((left < HeapSize) && HeapLess(Heap[left], Heap[smallest]))
+        {
+            smallest = left;
+        }
+        if ((right < HeapSize) && HeapLess(Heap[right], Heap[smallest]))
+        {
+            smallest = right;
+        }
+        if (smallest == position)
+        {
+            return;
+        }
+        uint32_t swap = Heap[position];
+        Heap[position] = Heap[smallest];
+        Heap[smallest] = swap;
+        position = smallest;
+    }
+}
+
+static void HeapPush(uint32_t session)
+{
+    uint32_t position = HeapSize++;
+    Heap[position] = session;
+    while (position > 0U)
+    {
+        uint32_t parent = (position - 1U) / 2U;
+        if (!HeapLess(Heap[position], Heap[parent]))
+        {
+            break;
+        }
+        uint32_t swap = Heap[position];
+        Heap[position] = Heap[parent];
+        Heap[parent] = swap;
+        position = parent;
+    }
+}
+
+static uint32_t HeapPop(void)
+{
+    uint32_t top = Heap[0];
+    Heap[0] = Heap[--HeapSize];
+    HeapSiftDown(0);
+    return (top);
+}
+
+static void SessionClose(Session_T * session)
+{
+    fclose(session->File);
+    free(session->Buffer);
+    session->File = NULL;
+    session->Buffer = NULL;
+}
+
+/**
+ * @brief Reads the next record of an open session into its line buffer and updates its key.
+ *
+ * @return 1 if a record was read, 0 at the end of the session (the file is closed)
+ */
+static int SessionAdvance(Session_T * session)
+{
+    while (NULL != fgets(session->Line, sizeof(session->Line), session->File))
+    {
+        if (XDKLOG_RECORD_INVALID != XdkLog_ParseLine(session->Line, &session->Record))
+        {
+            session->Key = WallTime(session, session->Record.Time);
+            return (1);
+        }
+    }
+    SessionClose(session);
+    return (0);
+}
+
+/**
+ * @brief Opens a pending session and reads its first record.
+ *
+ * @return 1 if a record was read, 0 for an empty session, -1 if the file cannot be opened
+ */
+static int SessionOpen(Session_T * session)
+{
+    session->File = fopen(session->Path, "r");
+    if (NULL == session->File)
+    {
+        fprintf(stderr, "xdk_merge: cannot open %s: %s\n", session->Path, strerror(errno));
+        return (-1);
+    }
+    session->Buffer = CheckedRealloc(NULL, READ_BUFFER_SIZE);
+    setvbuf(session->File, session->Buffer, _IOFBF, READ_BUFFER_SIZE);
+    session->State = SESSION_OPEN;
+    XdkLog_InitRecord(&session->Record);
+    return (SessionAdvance(session));
+}
+
+int main(int argc, char ** argv)
+{
+    if (2 != argc)
+    {
+        fprintf(stderr, "usage: xdk_merge anchors.txt > merged.csv\n");
+        return (EXIT_FAILURE);
+    }
+    if (!ReadAnchors(argv[1]))
+    {
+        return (EXIT_FAILURE);
+    }
+    if (!FitClocks())
+    {
+        return (EXIT_FAILURE);
+    }
+    for (uint32_t i = 0; i < DeviceCount; i++)
+    {
+        fprintf(stderr, "xdk_merge: %s drift %+.1f ppm\n", Devices[i].Name, (Devices[i].Slope - 1.0) * 1e6);
+    }
+
+    Heap = CheckedRealloc(NULL, (SessionCount + 1U) * sizeof(uint32_t));
+    for (uint32_t i = 0; i < SessionCount; i++)
+    {
+        /* Session times are never negative, so no record precedes the wall time of session time zero */
+        Sessions[i].Key = WallTime(&Sessions[i], 0U);
+        HeapPush(i);
+    }
+
+    int status = EXIT_SUCCESS;
+    uint64_t records = 0;
+    while (HeapSize > 0U)
+    {
+        uint32_t index = HeapPop();
+        Session_T * session = &Sessions[index];
+        if (SESSION_PENDING == session->State)
+        {
+            int opened = SessionOpen(session);
+            if (opened > 0)
+            {
+                HeapPush(index);
+            }
+            else if (opened < 0)
+            {
+                status = EXIT_FAILURE;
+            }
+            continue;
+        }
+        if (XDKLOG_RECORD_SAMPLE == session->Record.Type)
+        {
+            XdkLog_FormatSample(&session->Record, session->Line, sizeof(session->Line));
+        }
+        printf("%lld; %s; %s\n", (long long) session->Key, Devices[session->Device].Name, Trim(session->Line));
+        records++;
+        if (SessionAdvance(session))
+        {
+            HeapPush(index);
+        }
+    }
+    fprintf(stderr, "xdk_merge: %llu records from %u sessions of %u devices\n",
+            (unsigned long long) records, SessionCount, DeviceCount);
+    return (status);
+}
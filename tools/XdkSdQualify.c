@@ -0,0 +1,34 @@
+/**
+ * @file
+ * @brief Runs the firmware SD card qualification (source/SdQualify.c) against the host storage
+ * stand-in, see host/HostStorage.c for the environment variables emulating a card.
+ *
+ * Usage:
+ *   XDK_SD_DIR=/mnt/card xdk_sdqualify
+ */
+#include "SdQualify.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static uint8_t Scratch[SDQUALIFY_BUFFER_SIZE];
+
+int main(void)
+{
+    SdQualify_Tuning_T tuning;
+
+    Retcode_T retcode = SdQualify_Run(Scratch, sizeof(Scratch), &tuning);
+    if (RETCODE_OK != retcode)
+    {
+        fprintf(stderr, "xdk_sdqualify: qualification failed, retcode 0x%08lx\n", (unsigned long) retcode);
+        return (EXIT_FAILURE);
+    }
+    retcode = SdQualify_Load(&tuning);
+    if (RETCODE_OK != retcode)
+    {
+        fprintf(stderr, "xdk_sdqualify: stored tuning unreadable, retcode 0x%08lx\n", (unsigned long) retcode);
+        return (EXIT_FAILURE);
+    }
+    printf("flush %lu, depth %u\n", (unsigned long) tuning.FlushSize, (unsigned int) tuning.BufferDepth);
+    return (EXIT_SUCCESS);
+}
@@ -0,0 +1,127 @@
+/**
+ * @file
+ * @brief Host storage stand-in for the portable firmware modules.
+ *
+ * @details Storage_Write()/Storage_Read()/Storage_Delete() work on files of the directory named by XDK_SD_DIR
+ * (default: the current directory), with the same offset semantics as the XDK storage utility.
+ * Every write is synced to the host disk when XDK_SD_SYNC is set. Card garbage collection stalls
+ * can be emulated with XDK_SD_STALL_EVERY=<writes> and XDK_SD_STALL_MS=<ms>.
+ */
+#include "XDK_Storage.h"
+#include "task.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PATH_SIZE                   512U
+
+static uint32_t WriteCount = 0;
+
+static unsigned long EnvironmentValue(const char * name)
+{
+    const char * value = getenv(name);
+    return ((NULL != value) ? strtoul(value, NULL, 10) : 0UL);
+}
+
+static void BuildPath(char * path, const char * fileName)
+{
+    const char * directory = getenv("XDK_SD_DIR");
+    snprintf(path, PATH_SIZE, "%s/%s", (NULL != directory) ? directory : ".", fileName);
+}
+
+static void Stall(void)
+{
+    unsigned long every = EnvironmentValue("XDK_SD_STALL_EVERY");
+    unsigned long milliseconds = EnvironmentValue("XDK_SD_STALL_MS");
+
+    WriteCount++;
+    if ((0UL != every) && (0UL == (WriteCount % every)))
+    {
+        struct timespec delay = { (time_t) (milliseconds / 1000UL), (long) ((milliseconds % 1000UL) * 1000000UL) };
+        nanosleep(&delay, NULL);
+    }
+}
+
+void Retcode_RaiseError(Retcode_T error)
+{
+    fprintf(stderr, "Retcode_RaiseError: 0x%08lx\n", (unsigned long) error);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((TickType_t) (((uint64_t) now.tv_sec * 1000U) + ((uint64_t) now.tv_nsec / 1000000U)));
+}
+
+Retcode_T Storage_Write(Storage_Medium_T medium, Storage_Write_T * writeCredentials)
+{
+    char path[PATH_SIZE];
+
+    if ((STORAGE_MEDIUM_SD_CARD != medium) || (NULL == writeCredentials) || (NULL == writeCredentials->FileName))
+    {
+        return (RETCODE(RETCODE_SEVERITY_ERROR, RETCODE_INVALID_PARAM));
+    }
+    BuildPath(path, writeCredentials->FileName);
+    int file = open(path, O_WRONLY | O_CREAT, 0644);
+    if (file < 0)
+    {
+        return (RETCODE(RETCODE_SEVERITY_ERROR, RETCODE_FAILURE));
+    }
+    ssize_t written = pwrite(file, writeCredentials->WriteBuffer, writeCredentials->BytesToWrite, (off_t) writeCredentials->Offset);
+    if ((written >= 0) && (0UL != EnvironmentValue("XDK_SD_SYNC")))
+    {
+        fsync(file);
+    }
+    close(file);
+    Stall();
+    if (written < 0)
+    {
+        return (RETCODE(RETCODE_SEVERITY_ERROR, RETCODE_FAILURE));
+    }
+    writeCredentials->ActualBytesWritten = (uint32_t) written;
+    return (RETCODE_OK);
+}
+
+Retcode_T Storage_Read(Storage_Medium_T medium, Storage_Read_T * readCredentials)
+{
+    char path[PATH_SIZE];
+
+    if ((STORAGE_MEDIUM_SD_CARD != medium) || (NULL == readCredentials) || (NULL == readCredentials->FileName))
+    {
+        return (RETCODE(RETCODE_SEVERITY_ERROR, RETCODE_INVALID_PARAM));
+    }
+    BuildPath(path, readCredentials->FileName);
+    int file = open(path, O_RDONLY);
+    if (file < 0)
+    {
+        return (RETCODE(RETCODE_SEVERITY_ERROR, RETCODE_FAILURE));
+    }
+    ssize_t read = pread(file, readCredentials->ReadBuffer, readCredentials->BytesToRead, (off_t) readCredentials->Offset);
+    close(file);
+    if (read < 0)
+    {
+        return (RETCODE(RETCODE_SEVERITY_ERROR, RETCODE_FAILURE));
+    }
+    readCredentials->ActualBytesRead = (uint32_t) read;
+    return (RETCODE_OK);
+}
+
+Retcode_T Storage_Delete(Storage_Medium_T medium, const char * fileName)
+{
+    char path[PATH_SIZE];
+
+    if ((STORAGE_MEDIUM_SD_CARD != medium) || (NULL == fileName))
+    {
+        return (RETCODE(RETCODE_SEVERITY_ERROR, RETCODE_INVALID_PARAM));
+    }
+    BuildPath(path, fileName);
+    if (0 != unlink(path))
+    {
+        return (RETCODE(RETCODE_SEVERITY_ERROR, RETCODE_FAILURE));
+    }
+    return (RETCODE_OK);
+}
@@ -0,0 +1,15 @@
+/**
+ * @file
+ * @brief Host stand-in for the XDK basics header, see tools/host/HostStorage.c.
+ */
+#ifndef BCDS_BASICS_H_
+#define BCDS_BASICS_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define BCDS_UNUSED(x)              ((void) (x))
+
+#endif /* BCDS_BASICS_H_ */
@@ -0,0 +1,39 @@
+/**
+ * @file
+ * @brief Host stand-in for the XDK return codes, only the subset used by the portable modules.
+ */
+#ifndef BCDS_RETCODE_H_
+#define BCDS_RETCODE_H_
+
+#include "BCDS_Basics.h"
+
+typedef uint32_t Retcode_T;
+
+enum Retcode_Severity_E
+{
+    RETCODE_SEVERITY_NONE = 0,
+    RETCODE_SEVERITY_INFO,
+    RETCODE_SEVERITY_WARNING,
+    RETCODE_SEVERITY_ERROR,
+    RETCODE_SEVERITY_FATAL,
+};
+
+enum Retcode_General_E
+{
+    RETCODE_OK = 0,
+    RETCODE_FAILURE,
+    RETCODE_OUT_OF_RESOURCES,
+    RETCODE_INVALID_PARAM,
+    RETCODE_NOT_SUPPORTED,
+    RETCODE_INCONSITENT_STATE,
+    RETCODE_UNINITIALIZED,
+    RETCODE_NULL_POINTER,
+    RETCODE_FIRST_CUSTOM_CODE = 0x100,
+};
+
+#define RETCODE(severity, code)     ((Retcode_T) ((((uint32_t) (severity)) << 28) | ((uint32_t) (code) & 0x0FFFFFFFUL)))
+#define Retcode_GetCode(retcode)    ((uint32_t) (retcode) & 0x0FFFFFFFUL)
+
+void Retcode_RaiseError(Retcode_T error);
+
+#endif /* BCDS_RETCODE_H_ */
@@ -0,0 +1,15 @@
+/**
+ * @file
+ * @brief Host stand-in for the FreeRTOS tick types, one tick per millisecond as on the XDK.
+ */
+#ifndef FREERTOS_H_
+#define FREERTOS_H_
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+
+#define portTICK_PERIOD_MS          ((TickType_t) 1)
+#define pdMS_TO_TICKS(ms)           ((TickType_t) (ms))
+
+#endif /* FREERTOS_H_ */
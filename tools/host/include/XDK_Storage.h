@@ -0,0 +1,41 @@
+/**
+ * @file
+ * @brief Host stand-in for the XDK storage API, backed by files in a host directory.
+ */
+#ifndef XDK_STORAGE_H_
+#define XDK_STORAGE_H_
+
+#include "BCDS_Retcode.h"
+
+typedef enum
+{
+    STORAGE_MEDIUM_SD_CARD,
+    STORAGE_MEDIUM_WIFI_FILE_SYSTEM,
+    STORAGE_MEDIUM_MAX,
+} Storage_Medium_T;
+
+typedef struct
+{
+    const char * FileName;
+    uint8_t * WriteBuffer;
+    uint32_t BytesToWrite;
+    uint32_t ActualBytesWritten;
+    uint32_t Offset;
+} Storage_Write_T;
+
+typedef struct
+{
+    const char * FileName;
+    uint8_t * ReadBuffer;
+    uint32_t BytesToRead;
+    uint32_t ActualBytesRead;
+    uint32_t Offset;
+} Storage_Read_T;
+
+Retcode_T Storage_Write(Storage_Medium_T medium, Storage_Write_T * writeCredentials);
+
+Retcode_T Storage_Read(Storage_Medium_T medium, Storage_Read_T * readCredentials);
+
+Retcode_T Storage_Delete(Storage_Medium_T medium, const char * fileName);
+
+#endif /* XDK_STORAGE_H_ */
@@ -0,0 +1,11 @@
+/**
+ * @file
+ * @brief Host stand-in for the XDK utilities header.
+ */
+#ifndef XDK_UTILS_H_
+#define XDK_UTILS_H_
+
+#include "BCDS_Basics.h"
+#include "BCDS_Retcode.h"
+
+#endif /* XDK_UTILS_H_ */
@@ -0,0 +1,11 @@
+/**
+ * @file
+ * @brief Host stand-in for the XDK common module and return code ranges.
+ */
+#ifndef XDKCOMMONINFO_H_
+#define XDKCOMMONINFO_H_
+
+#define XDK_COMMON_ID_OVERFLOW                  100
+#define RETCODE_XDK_APP_FIRST_CUSTOM_CODE       0x200
+
+#endif /* XDKCOMMONINFO_H_ */
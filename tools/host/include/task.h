@@ -0,0 +1,12 @@
+/**
+ * @file
+ * @brief Host stand-in for the FreeRTOS task API, the tick count follows the host monotonic clock.
+ */
+#ifndef TASK_H_
+#define TASK_H_
+
+#include "FreeRTOS.h"
+
+TickType_t xTaskGetTickCount(void);
+
+#endif /* TASK_H_ */